@@ -0,0 +1,49 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "compiled-nfa.hpp"
+#include "minimizer.hpp"
+#include "nfa.hpp"
+
+// Times the minimizers on the DFA of (a+b)*a(a+b)^DEPTH, which has
+// 2^(DEPTH + 1) states and takes DEPTH + 2 Moore rounds.
+//
+// Usage: minimizer-bench [DEPTH [THREADS]]
+int main(int argc, char **argv) {
+  int depth = argc > 1 ? std::atoi(argv[1]) : 20;
+  unsigned threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+  std::string regex = "(a+b)*.a";
+  for (int i = 0; i < depth; ++i) {
+    regex += ".(a+b)";
+  }
+
+  WorkStealingPool pool(threads);
+  NFA nfa(regex);
+  nfa.ToDFA(pool);
+  CompiledNFA dfa(nfa);
+
+  std::vector<int> initial(dfa.StateCount());
+  for (int state = 0; state < dfa.StateCount(); ++state) {
+    initial[state] = dfa.IsFinal(state);
+  }
+
+  auto time = [](const char *name, auto &&minimize) {
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<int> blocks = minimize();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() << " s, "
+              << DFAMinimizer::CanonicalizeBlocks(blocks) << " blocks\n";
+  };
+
+  std::cout << dfa.StateCount() << " states, " << pool.ThreadCount()
+            << " threads\n";
+  time("Hopcroft", [&] { return DFAMinimizer::Hopcroft(dfa, initial); });
+  time("Moore", [&] { return DFAMinimizer::Moore(dfa, initial); });
+  time("ParallelMoore",
+       [&] { return DFAMinimizer::ParallelMoore(dfa, initial, pool); });
+  return 0;
+}
@@ -0,0 +1,38 @@
+# regex_generate_matcher(<target> NAME <name> REGEX <regex> [TABLE])
+#
+# Runs regex-codegen at build time and makes the generated header
+# <name>.hpp, which declares namespace <name>, includable from <target>.
+# The header is regenerated when the regex or the generator changes, but it
+# is only replaced when its contents differ, so its dependents are not
+# recompiled needlessly. A stamp file records that the step has run.
+function(regex_generate_matcher target)
+    cmake_parse_arguments(ARG "TABLE" "NAME;REGEX" "" ${ARGN})
+    if(NOT ARG_NAME OR NOT ARG_REGEX)
+        message(FATAL_ERROR "regex_generate_matcher needs NAME and REGEX")
+    endif()
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/regex-generated)
+    set(output ${output_dir}/${ARG_NAME}.hpp)
+    set(temporary ${output_dir}/${ARG_NAME}.hpp.tmp)
+    set(stamp ${output_dir}/${ARG_NAME}.stamp)
+    set(style_flag)
+    if(ARG_TABLE)
+        set(style_flag --table)
+    endif()
+
+    add_custom_command(
+        OUTPUT ${stamp}
+        BYPRODUCTS ${output}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}
+        COMMAND regex-codegen ${style_flag} --namespace ${ARG_NAME}
+                "${ARG_REGEX}" ${temporary}
+        COMMAND ${CMAKE_COMMAND} -E copy_if_different ${temporary} ${output}
+        COMMAND ${CMAKE_COMMAND} -E touch ${stamp}
+        DEPENDS regex-codegen
+        COMMENT "Generating matcher ${ARG_NAME} for ${ARG_REGEX}"
+        VERBATIM
+    )
+
+    target_sources(${target} PRIVATE ${output} ${stamp})
+    target_include_directories(${target} PRIVATE ${output_dir})
+endfunction()
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nfa.hpp"
+
+// Simulates the Glushkov position automaton of a short pattern with the
+// active positions held in `Words` machine words, so there is no DFA to
+// build and no state sets to merge. Every edge into a position carries that
+// position's symbol, so one step is
+//
+//   active = Follow(active) & symbol_mask[byte]
+//
+// For a plain concatenation Follow is a shift and this is Shift-And. In
+// general Follow is assembled from tables indexed by each byte of the
+// active mask, which keeps the cost per input byte independent of the
+// pattern's structure. Patterns may have up to 64 * Words - 1 symbols.
+template <int Words = 1> class BitParallelMatcher {
+  struct Mask {
+    std::array<uint64_t, Words> words{};
+
+    void Set(int bit) { words[bit / 64] |= uint64_t{1} << (bit % 64); }
+
+    bool Any() const {
+      uint64_t any = 0;
+      for (uint64_t word : words) {
+        any |= word;
+      }
+      return any != 0;
+    }
+
+    Mask &operator|=(const Mask &other) {
+      for (int i = 0; i < Words; ++i) {
+        words[i] |= other.words[i];
+      }
+      return *this;
+    }
+
+    Mask &operator&=(const Mask &other) {
+      for (int i = 0; i < Words; ++i) {
+        words[i] &= other.words[i];
+      }
+      return *this;
+    }
+
+    bool Intersects(const Mask &other) const {
+      Mask both = *this;
+      both &= other;
+      return both.Any();
+    }
+  };
+
+  std::array<Mask, 256> symbol_masks_{};
+  // follow_[chunk * 256 + b]: positions following any position set in byte
+  // `chunk` of the active mask, when that byte is b.
+  std::vector<Mask> follow_;
+  int chunk_count_ = 0;
+  Mask finals_;
+
+  Mask Step(const Mask &active, unsigned char byte) const {
+    Mask next;
+    for (int chunk = 0; chunk < chunk_count_; ++chunk) {
+      unsigned index = (active.words[chunk / 8] >> (chunk % 8 * 8)) & 0xff;
+      next |= follow_[chunk * 256 + index];
+    }
+    next &= symbol_masks_[byte];
+    return next;
+  }
+
+public:
+  static constexpr int kMaxPositions = 64 * Words;
+
+  explicit BitParallelMatcher(const std::string &regex) {
+    NFA automaton(regex, NFAConstruction::Glushkov);
+    const auto &states = automaton.GetStates();
+    int positions = static_cast<int>(states.size());
+    if (positions > kMaxPositions) {
+      throw std::runtime_error("Pattern has too many symbols for " +
+                               std::to_string(Words) + " words");
+    }
+
+    // The start state is created first, so position i is states[i].
+    int first_id = states.front()->id;
+    std::vector<Mask> follow(positions);
+    for (int p = 0; p < positions; ++p) {
+      if (states[p]->is_final) {
+        finals_.Set(p);
+      }
+      for (const auto &[symbol, targets] : states[p]->transitions) {
+        for (int target : targets) {
+          follow[p].Set(target - first_id);
+          symbol_masks_[static_cast<unsigned char>(symbol)].Set(target -
+                                                                first_id);
+        }
+      }
+    }
+
+    chunk_count_ = (positions + 7) / 8;
+    follow_.assign(static_cast<size_t>(chunk_count_) * 256, Mask{});
+    for (int chunk = 0; chunk < chunk_count_; ++chunk) {
+      Mask *table = follow_.data() + chunk * 256;
+      for (unsigned b = 1; b < 256; ++b) {
+        int bit = chunk * 8 + __builtin_ctz(b);
+        table[b] = table[b & (b - 1)];
+        if (bit < positions) {
+          table[b] |= follow[bit];
+        }
+      }
+    }
+  }
+
+  // Same result as NFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const {
+    Mask active;
+    active.Set(0);
+    int64_t longest_match = active.Intersects(finals_) ? 0 : -1;
+
+    for (size_t i = 0; i < str.size(); ++i) {
+      active = Step(active, static_cast<unsigned char>(str[i]));
+      if (!active.Any()) {
+        break;
+      }
+      if (active.Intersects(finals_)) {
+        longest_match = static_cast<int64_t>(i + 1);
+      }
+    }
+    return longest_match;
+  }
+
+  bool Matches(std::string_view str) const {
+    Mask active;
+    active.Set(0);
+    for (size_t i = 0; i < str.size() && active.Any(); ++i) {
+      active = Step(active, static_cast<unsigned char>(str[i]));
+    }
+    return active.Intersects(finals_);
+  }
+};
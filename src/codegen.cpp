@@ -0,0 +1,181 @@
+#include "codegen.hpp"
+
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+#include "dense-dfa.hpp"
+
+namespace {
+
+std::string ByteLiteral(int byte) {
+  if (std::isalnum(byte)) {
+    return std::string("'") + static_cast<char>(byte) + "'";
+  }
+  return std::to_string(byte);
+}
+
+void EmitPrologue(std::ostringstream &out,
+                  const CodeGenerator::Options &options) {
+  out << "// Generated by regex-codegen";
+  if (!options.source_regex.empty()) {
+    out << " from \"" << options.source_regex << "\"";
+  }
+  out << ". Do not edit.\n"
+         "#pragma once\n\n"
+         "#include <cstddef>\n"
+         "#include <string_view>\n\n"
+         "namespace "
+      << options.namespace_name << " {\n\n";
+}
+
+// One switch per state; bytes are grouped by target state.
+void EmitDirectCoded(std::ostringstream &out, const DenseDFA &dfa,
+                     bool longest_prefix) {
+  if (longest_prefix) {
+    out << "inline std::ptrdiff_t longest_prefix(std::string_view input) {\n";
+  } else {
+    out << "inline bool match(std::string_view input) {\n";
+  }
+  out << "  const auto *data = reinterpret_cast<const unsigned char "
+         "*>(input.data());\n"
+         "  const std::size_t size = input.size();\n"
+         "  std::size_t i = 0;\n";
+  if (longest_prefix) {
+    out << "  std::ptrdiff_t longest = -1;\n";
+  }
+  if (dfa.GetStart() == DenseDFA::kDeadState) {
+    out << "  (void)data;\n"
+           "  (void)size;\n"
+           "  (void)i;\n"
+        << "  return " << (longest_prefix ? "-1" : "false") << ";\n}\n\n";
+    return;
+  }
+  out << "  goto state_" << dfa.GetStart() << ";\n";
+
+  std::string on_stop = longest_prefix ? "return longest;" : "return false;";
+
+  for (int state = 1; state < dfa.StateCount(); ++state) {
+    out << "state_" << state << ":\n";
+    if (longest_prefix && dfa.IsFinal(state)) {
+      out << "  longest = static_cast<std::ptrdiff_t>(i);\n";
+    }
+    out << "  if (i == size) {\n";
+    if (longest_prefix) {
+      out << "    return longest;\n";
+    } else {
+      out << "    return " << (dfa.IsFinal(state) ? "true" : "false") << ";\n";
+    }
+    out << "  }\n"
+           "  switch (data[i++]) {\n";
+
+    std::vector<std::vector<int>> bytes_to(dfa.StateCount());
+    for (int byte = 0; byte < 256; ++byte) {
+      int target = dfa.Next(state, static_cast<unsigned char>(byte));
+      if (target != DenseDFA::kDeadState) {
+        bytes_to[target].push_back(byte);
+      }
+    }
+    for (int target = 1; target < dfa.StateCount(); ++target) {
+      if (bytes_to[target].empty()) {
+        continue;
+      }
+      for (int byte : bytes_to[target]) {
+        out << "  case " << ByteLiteral(byte) << ":\n";
+      }
+      out << "    goto state_" << target << ";\n";
+    }
+    out << "  default:\n"
+           "    "
+        << on_stop
+        << "\n"
+           "  }\n";
+  }
+  out << "}\n\n";
+}
+
+void EmitTable(std::ostringstream &out, const DenseDFA &dfa) {
+  out << "namespace detail {\n\n"
+         "inline constexpr int kStart = "
+      << dfa.GetStart()
+      << ";\n"
+         "inline constexpr int kClassCount = "
+      << dfa.ClassCount() << ";\n\n";
+
+  out << "inline constexpr unsigned char kClasses[256] = {";
+  for (int byte = 0; byte < 256; ++byte) {
+    out << (byte % 16 == 0 ? "\n    " : " ")
+        << dfa.GetClass(static_cast<unsigned char>(byte)) << ",";
+  }
+  out << "\n};\n\n";
+
+  // Rebuild each row from a representative byte of every class.
+  std::vector<int> class_byte(dfa.ClassCount(), 0);
+  for (int byte = 255; byte >= 0; --byte) {
+    class_byte[dfa.GetClass(static_cast<unsigned char>(byte))] = byte;
+  }
+
+  out << "inline constexpr int kTable[" << dfa.StateCount() * dfa.ClassCount()
+      << "] = {";
+  for (int state = 0; state < dfa.StateCount(); ++state) {
+    out << "\n   ";
+    for (int c = 0; c < dfa.ClassCount(); ++c) {
+      out << " " << dfa.Next(state, static_cast<unsigned char>(class_byte[c]))
+          << ",";
+    }
+  }
+  out << "\n};\n\n";
+
+  out << "inline constexpr bool kFinals[" << dfa.StateCount() << "] = {";
+  for (int state = 0; state < dfa.StateCount(); ++state) {
+    out << (state % 16 == 0 ? "\n    " : " ")
+        << (dfa.IsFinal(state) ? "true" : "false") << ",";
+  }
+  out << "\n};\n\n"
+         "} // namespace detail\n\n";
+
+  out << "inline std::ptrdiff_t longest_prefix(std::string_view input) {\n"
+         "  int state = detail::kStart;\n"
+         "  std::ptrdiff_t longest = detail::kFinals[state] ? 0 : -1;\n"
+         "  for (std::size_t i = 0; i < input.size(); ++i) {\n"
+         "    state = detail::kTable[state * detail::kClassCount +\n"
+         "                           detail::kClasses[static_cast<unsigned "
+         "char>(input[i])]];\n"
+         "    if (state == 0) {\n"
+         "      break;\n"
+         "    }\n"
+         "    if (detail::kFinals[state]) {\n"
+         "      longest = static_cast<std::ptrdiff_t>(i + 1);\n"
+         "    }\n"
+         "  }\n"
+         "  return longest;\n"
+         "}\n\n";
+
+  out << "inline bool match(std::string_view input) {\n"
+         "  int state = detail::kStart;\n"
+         "  for (std::size_t i = 0; i < input.size() && state != 0; ++i) {\n"
+         "    state = detail::kTable[state * detail::kClassCount +\n"
+         "                           detail::kClasses[static_cast<unsigned "
+         "char>(input[i])]];\n"
+         "  }\n"
+         "  return detail::kFinals[state];\n"
+         "}\n\n";
+}
+
+} // namespace
+
+std::string CodeGenerator::Generate(const NFA &dfa, const Options &options) {
+  DenseDFA dense(dfa);
+  std::ostringstream out;
+
+  EmitPrologue(out, options);
+  if (options.style == Style::DirectCoded) {
+    EmitDirectCoded(out, dense, true);
+    EmitDirectCoded(out, dense, false);
+  } else {
+    EmitTable(out, dense);
+  }
+  out << "} // namespace " << options.namespace_name << "\n";
+
+  return out.str();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "nfa.hpp"
+
+// Emits a deterministic NFA (usually the result of ToMinimal) as a
+// self-contained C++ header with two functions in the given namespace:
+//
+//   std::ptrdiff_t longest_prefix(std::string_view input);  // ContainsPrefix
+//   bool match(std::string_view input);
+//
+// Direct-coded output turns every state into a label with a switch over the
+// next byte; table output embeds the DenseDFA tables as constexpr arrays.
+class CodeGenerator {
+public:
+  enum class Style { DirectCoded, Table };
+
+  struct Options {
+    std::string namespace_name = "generated_regex";
+    Style style = Style::DirectCoded;
+    // Recorded in the header comment.
+    std::string source_regex;
+  };
+
+  static std::string Generate(const NFA &dfa, const Options &options);
+};
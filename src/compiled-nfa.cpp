@@ -0,0 +1,400 @@
+#include "compiled-nfa.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+bool SymbolLess(char a, char b) {
+  return static_cast<unsigned char>(a) < static_cast<unsigned char>(b);
+}
+
+} // namespace
+
+CompiledNFA::CompiledNFA(const NFA &nfa) {
+  const auto &states = nfa.GetStates();
+  int n = static_cast<int>(states.size());
+
+  std::unordered_map<int, int> index_of;
+  index_of.reserve(states.size());
+  original_ids_.reserve(states.size());
+  for (const auto &state : states) {
+    index_of[state->id] = static_cast<int>(original_ids_.size());
+    original_ids_.push_back(state->id);
+  }
+
+  auto start = index_of.find(nfa.start_id_);
+  start_ = start == index_of.end() ? -1 : start->second;
+
+  offsets_.reserve(n + 1);
+  offsets_.push_back(0);
+  pattern_offsets_.reserve(n + 1);
+  pattern_offsets_.push_back(0);
+  final_bits_.assign((n + 63) / 64, 0);
+
+  std::vector<std::pair<char, int>> edges;
+  for (int i = 0; i < n; ++i) {
+    const auto &state = states[i];
+    if (state->is_final) {
+      final_bits_[i >> 6] |= uint64_t{1} << (i & 63);
+    }
+    pattern_ids_.insert(pattern_ids_.end(), state->pattern_ids.begin(),
+                        state->pattern_ids.end());
+    pattern_offsets_.push_back(static_cast<int>(pattern_ids_.size()));
+
+    edges.clear();
+    for (const auto &trans : state->transitions) {
+      for (int to_id : trans.second) {
+        auto target = index_of.find(to_id);
+        if (target != index_of.end()) {
+          edges.emplace_back(trans.first, target->second);
+        }
+      }
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const auto &a, const auto &b) {
+      if (a.first != b.first) {
+        return SymbolLess(a.first, b.first);
+      }
+      return a.second < b.second;
+    });
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (const auto &[symbol, target] : edges) {
+      symbols_.push_back(symbol);
+      targets_.push_back(target);
+    }
+    offsets_.push_back(static_cast<int>(symbols_.size()));
+  }
+
+  for (char symbol : nfa.alphabet_) {
+    if (symbol != kEpsilon) {
+      alphabet_.push_back(symbol);
+    }
+  }
+  std::sort(alphabet_.begin(), alphabet_.end(), SymbolLess);
+
+  ComputeEpsilonClosures();
+}
+
+bool CompiledNFA::IsImportant(int state) const {
+  return IsFinal(state) || (offsets_[state] != offsets_[state + 1] &&
+                            symbols_[offsets_[state + 1] - 1] != kEpsilon);
+}
+
+void CompiledNFA::CondenseEpsilonCycles() {
+  int n = StateCount();
+  component_of_.assign(n, -1);
+
+  // Iterative Tarjan over epsilon edges. Components are numbered in reverse
+  // topological order: every epsilon edge leads to the same or to a smaller
+  // component.
+  std::vector<int> index(n, -1);
+  std::vector<int> lowlink(n, 0);
+  std::vector<char> on_stack(n, 0);
+  std::vector<int> stack;
+  std::vector<std::pair<int, int>> call_stack;
+  int next_index = 0;
+  int component_count = 0;
+
+  for (int root = 0; root < n; ++root) {
+    if (index[root] != -1) {
+      continue;
+    }
+
+    call_stack.emplace_back(root, offsets_[root]);
+    index[root] = lowlink[root] = next_index++;
+    stack.push_back(root);
+    on_stack[root] = 1;
+
+    while (!call_stack.empty()) {
+      auto &[state, edge] = call_stack.back();
+
+      if (edge < offsets_[state + 1] && symbols_[edge] == kEpsilon) {
+        int next = targets_[edge++];
+        if (index[next] == -1) {
+          index[next] = lowlink[next] = next_index++;
+          stack.push_back(next);
+          on_stack[next] = 1;
+          call_stack.emplace_back(next, offsets_[next]);
+        } else if (on_stack[next]) {
+          lowlink[state] = std::min(lowlink[state], index[next]);
+        }
+        continue;
+      }
+
+      int finished = state;
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        int parent = call_stack.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+      }
+
+      if (lowlink[finished] == index[finished]) {
+        int member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = 0;
+          component_of_[member] = component_count;
+        } while (member != finished);
+        ++component_count;
+      }
+    }
+  }
+
+  component_members_offsets_.assign(component_count + 1, 0);
+  for (int state = 0; state < n; ++state) {
+    ++component_members_offsets_[component_of_[state] + 1];
+  }
+  for (int c = 0; c < component_count; ++c) {
+    component_members_offsets_[c + 1] += component_members_offsets_[c];
+  }
+  component_members_.resize(n);
+  {
+    std::vector<int> fill(component_members_offsets_.begin(),
+                          component_members_offsets_.end() - 1);
+    for (int state = 0; state < n; ++state) {
+      component_members_[fill[component_of_[state]]++] = state;
+    }
+  }
+
+  component_offsets_.assign(1, 0);
+  component_targets_.clear();
+  std::vector<int> successors;
+  for (int c = 0; c < component_count; ++c) {
+    successors.clear();
+    for (int i = component_members_offsets_[c];
+         i < component_members_offsets_[c + 1]; ++i) {
+      int from = component_members_[i];
+      for (int e = offsets_[from];
+           e < offsets_[from + 1] && symbols_[e] == kEpsilon; ++e) {
+        if (component_of_[targets_[e]] != c) {
+          successors.push_back(component_of_[targets_[e]]);
+        }
+      }
+    }
+    std::sort(successors.begin(), successors.end());
+    successors.erase(std::unique(successors.begin(), successors.end()),
+                     successors.end());
+    component_targets_.insert(component_targets_.end(), successors.begin(),
+                              successors.end());
+    component_offsets_.push_back(static_cast<int>(component_targets_.size()));
+  }
+}
+
+void CompiledNFA::CollectClosure(int component, std::vector<int> &visited,
+                                 int stamp, std::vector<int> &closure) const {
+  std::vector<int> to_process{component};
+  visited[component] = stamp;
+
+  while (!to_process.empty()) {
+    int current = to_process.back();
+    to_process.pop_back();
+
+    for (int i = component_members_offsets_[current];
+         i < component_members_offsets_[current + 1]; ++i) {
+      if (IsImportant(component_members_[i])) {
+        closure.push_back(component_members_[i]);
+      }
+    }
+
+    for (int i = component_offsets_[current];
+         i < component_offsets_[current + 1]; ++i) {
+      int next = component_targets_[i];
+      if (visited[next] != stamp) {
+        visited[next] = stamp;
+        to_process.push_back(next);
+      }
+    }
+  }
+}
+
+void CompiledNFA::ComputeEpsilonClosures() {
+  CondenseEpsilonCycles();
+
+  int n = StateCount();
+  int component_count = static_cast<int>(component_offsets_.size()) - 1;
+
+  // A lone unimportant state with a single epsilon successor has the same
+  // closure as that successor. Successors have smaller numbers, so one
+  // forward pass resolves whole chains.
+  std::vector<int> representative(component_count);
+  for (int c = 0; c < component_count; ++c) {
+    int members =
+        component_members_offsets_[c + 1] - component_members_offsets_[c];
+    int successors = component_offsets_[c + 1] - component_offsets_[c];
+    representative[c] = c;
+    if (members == 1 && successors == 1 &&
+        !IsImportant(component_members_[component_members_offsets_[c]])) {
+      representative[c] =
+          representative[component_targets_[component_offsets_[c]]];
+    }
+  }
+
+  closure_of_.assign(n, -1);
+  closure_offsets_.assign(1, 0);
+  closure_states_.clear();
+
+  std::vector<int> slot_of(component_count, -1);
+  std::vector<int> visited(component_count, 0);
+  std::vector<int> closure;
+  int stamp = 0;
+
+  auto store = [&](int state) {
+    int c = representative[component_of_[state]];
+    if (slot_of[c] == -1) {
+      closure.clear();
+      CollectClosure(c, visited, ++stamp, closure);
+      std::sort(closure.begin(), closure.end());
+      closure_states_.insert(closure_states_.end(), closure.begin(),
+                             closure.end());
+      slot_of[c] = static_cast<int>(closure_offsets_.size()) - 1;
+      closure_offsets_.push_back(static_cast<int>(closure_states_.size()));
+    }
+    closure_of_[state] = slot_of[c];
+  };
+
+  if (start_ >= 0) {
+    store(start_);
+  }
+  for (size_t e = 0; e < targets_.size(); ++e) {
+    if (symbols_[e] != kEpsilon) {
+      store(targets_[e]);
+    }
+  }
+}
+
+int CompiledNFA::FindTarget(int state, char symbol) const {
+  auto begin = symbols_.begin() + offsets_[state];
+  auto end = symbols_.begin() + offsets_[state + 1];
+  auto it = std::lower_bound(begin, end, symbol, SymbolLess);
+  if (it == end || *it != symbol) {
+    return -1;
+  }
+  return targets_[it - symbols_.begin()];
+}
+
+std::vector<int>
+CompiledNFA::EpsilonClosure(const std::vector<int> &states) const {
+  std::vector<int> visited(component_offsets_.size() - 1, 0);
+  std::vector<int> closure;
+
+  for (int state : states) {
+    if (visited[component_of_[state]] == 0) {
+      CollectClosure(component_of_[state], visited, 1, closure);
+    }
+  }
+
+  std::sort(closure.begin(), closure.end());
+  return closure;
+}
+
+std::vector<int>
+CompiledNFA::FindReachableInOneStep(const std::vector<int> &states,
+                                    char symbol) const {
+  std::vector<int> result;
+  FindReachableInOneStep(states.data(), states.data() + states.size(), symbol,
+                         result);
+  return result;
+}
+
+void CompiledNFA::FindReachableInOneStep(const int *begin, const int *end,
+                                         char symbol,
+                                         std::vector<int> &result) const {
+  StepScratch scratch;
+  FindReachableInOneStep(begin, end, symbol, result, scratch);
+}
+
+void CompiledNFA::FindReachableInOneStep(const int *begin, const int *end,
+                                         char symbol, std::vector<int> &result,
+                                         StepScratch &scratch) const {
+  // Many targets share a stored closure, so each distinct one is merged once.
+  std::vector<int> &slots = scratch.slots;
+  slots.clear();
+  result.clear();
+
+  for (const int *state = begin; state != end; ++state) {
+    auto edges_begin = symbols_.begin() + offsets_[*state];
+    auto edges_end = symbols_.begin() + offsets_[*state + 1];
+    auto it = std::lower_bound(edges_begin, edges_end, symbol, SymbolLess);
+    for (; it != edges_end && *it == symbol; ++it) {
+      slots.push_back(closure_of_[targets_[it - symbols_.begin()]]);
+    }
+  }
+
+  std::sort(slots.begin(), slots.end());
+  slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+  if (slots.size() == 1) {
+    result.assign(closure_states_.begin() + closure_offsets_[slots[0]],
+                  closure_states_.begin() + closure_offsets_[slots[0] + 1]);
+    return;
+  }
+
+  // `seen` is all zero between calls; only the bits set here are cleared.
+  std::vector<uint64_t> &seen = scratch.seen;
+  seen.resize(final_bits_.size(), 0);
+  for (int slot : slots) {
+    for (int i = closure_offsets_[slot]; i < closure_offsets_[slot + 1]; ++i) {
+      int state = closure_states_[i];
+      if (!((seen[state >> 6] >> (state & 63)) & 1)) {
+        seen[state >> 6] |= uint64_t{1} << (state & 63);
+        result.push_back(state);
+      }
+    }
+  }
+  for (int state : result) {
+    seen[state >> 6] = 0;
+  }
+
+  std::sort(result.begin(), result.end());
+}
+
+bool CompiledNFA::ContainsFinalState(const std::vector<int> &states) const {
+  return std::any_of(states.begin(), states.end(),
+                     [this](int state) { return IsFinal(state); });
+}
+
+void CompiledNFA::CollectPatternIds(const std::vector<int> &states,
+                                    std::vector<int> &ids) const {
+  ids.clear();
+  for (int state : states) {
+    ids.insert(ids.end(), PatternIdsBegin(state), PatternIdsEnd(state));
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+int64_t CompiledNFA::ContainsPrefix(const std::string &str) const {
+  if (start_ < 0) {
+    return -1;
+  }
+
+  std::vector<int> current(ClosureBegin(start_), ClosureEnd(start_));
+  std::vector<int> next;
+  StepScratch scratch;
+  int64_t longest_match = -1;
+
+  if (ContainsFinalState(current)) {
+    longest_match = 0;
+  }
+
+  for (size_t i = 0; i < str.length(); i++) {
+    FindReachableInOneStep(current.data(), current.data() + current.size(),
+                           str[i], next, scratch);
+
+    if (next.empty()) {
+      break;
+    }
+
+    std::swap(current, next);
+
+    if (ContainsFinalState(current)) {
+      longest_match = static_cast<int64_t>(i + 1);
+    }
+  }
+
+  return longest_match;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nfa.hpp"
+
+// Immutable, contiguous form of an NFA used by the read-only algorithms.
+// States are renumbered densely (0..StateCount()-1) in the order of
+// NFA::GetStates(). The outgoing edges of state s occupy the index range
+// [EdgesBegin(s), EdgesEnd(s)) of the symbol/target arrays, sorted by symbol
+// with epsilon edges first.
+//
+// Epsilon closures are computed once at construction. Epsilon-cycles are
+// condensed into strongly connected components, closures only keep the
+// states that matter for matching (final states and states with symbol
+// edges), and they are stored for the states a step can land in: the start
+// state and the targets of symbol edges. Chains of plain epsilon states share
+// one stored list.
+class CompiledNFA {
+  int start_ = -1;
+
+  std::vector<int> original_ids_;
+  std::vector<int> offsets_;
+  std::vector<char> symbols_;
+  std::vector<int> targets_;
+  std::vector<uint64_t> final_bits_;
+  std::vector<int> pattern_offsets_;
+  std::vector<int> pattern_ids_;
+  std::vector<char> alphabet_;
+
+  std::vector<int> component_of_;
+  std::vector<int> component_offsets_;
+  std::vector<int> component_targets_;
+  std::vector<int> component_members_offsets_;
+  std::vector<int> component_members_;
+
+  std::vector<int> closure_of_;
+  std::vector<int> closure_offsets_;
+  std::vector<int> closure_states_;
+
+  bool IsImportant(int state) const;
+  void CondenseEpsilonCycles();
+  void ComputeEpsilonClosures();
+  void CollectClosure(int component, std::vector<int> &visited, int stamp,
+                      std::vector<int> &closure) const;
+
+public:
+  static constexpr char kEpsilon = 0;
+
+  // Buffers reused by FindReachableInOneStep, so stepping does not allocate
+  // once they have grown. Each thread needs its own.
+  struct StepScratch {
+    std::vector<int> slots;
+    std::vector<uint64_t> seen;
+  };
+
+  CompiledNFA() = default;
+  explicit CompiledNFA(const NFA &nfa);
+
+  int StateCount() const { return static_cast<int>(original_ids_.size()); }
+
+  int GetStart() const { return start_; }
+
+  int GetOriginalId(int state) const { return original_ids_[state]; }
+
+  bool IsFinal(int state) const {
+    return (final_bits_[state >> 6] >> (state & 63)) & 1;
+  }
+
+  // Pattern ids accepted by `state`, see NFAFactory::PatternsToNfa.
+  bool HasPatternIds() const { return !pattern_ids_.empty(); }
+
+  const int *PatternIdsBegin(int state) const {
+    return pattern_ids_.data() + pattern_offsets_[state];
+  }
+
+  const int *PatternIdsEnd(int state) const {
+    return pattern_ids_.data() + pattern_offsets_[state + 1];
+  }
+
+  int EdgesBegin(int state) const { return offsets_[state]; }
+
+  int EdgesEnd(int state) const { return offsets_[state + 1]; }
+
+  char EdgeSymbol(int edge) const { return symbols_[edge]; }
+
+  int EdgeTarget(int edge) const { return targets_[edge]; }
+
+  // Symbols (without epsilon) in increasing order.
+  const std::vector<char> &GetAlphabet() const { return alphabet_; }
+
+  // Returns the first target of `state` on `symbol`, or -1. Intended for
+  // deterministic automata.
+  int FindTarget(int state, char symbol) const;
+
+  // Precomputed closure of the start state or of a symbol edge target as a
+  // sorted range.
+  bool HasStoredClosure(int state) const { return closure_of_[state] != -1; }
+
+  const int *ClosureBegin(int state) const {
+    return closure_states_.data() + closure_offsets_[closure_of_[state]];
+  }
+
+  const int *ClosureEnd(int state) const {
+    return closure_states_.data() + closure_offsets_[closure_of_[state] + 1];
+  }
+
+  // All sets below are sorted vectors of dense state indices. Closed sets
+  // only contain final states and states with symbol edges.
+  std::vector<int> EpsilonClosure(const std::vector<int> &states) const;
+  // Returns the epsilon closure of the states reachable over `symbol`.
+  std::vector<int> FindReachableInOneStep(const std::vector<int> &states,
+                                          char symbol) const;
+  void FindReachableInOneStep(const int *begin, const int *end, char symbol,
+                              std::vector<int> &result) const;
+  void FindReachableInOneStep(const int *begin, const int *end, char symbol,
+                              std::vector<int> &result,
+                              StepScratch &scratch) const;
+  bool ContainsFinalState(const std::vector<int> &states) const;
+  // Sorted union of the pattern ids accepted by `states`.
+  void CollectPatternIds(const std::vector<int> &states,
+                         std::vector<int> &ids) const;
+
+  int64_t ContainsPrefix(const std::string &str) const;
+};
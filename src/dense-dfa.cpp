@@ -0,0 +1,290 @@
+#include "dense-dfa.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include "compiled-nfa.hpp"
+#include "mapped-file.hpp"
+
+namespace {
+
+// Layout of a serialized DenseDFA: this header, then the class map, the
+// transition table and the finality flags at the recorded offsets. All
+// integers are in host byte order; the byte order mark rejects images from
+// machines with a different one.
+struct ImageHeader {
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t version;
+  uint32_t state_count;
+  uint32_t class_count;
+  int32_t start;
+  uint32_t reserved;
+  uint64_t classes_offset;
+  uint64_t table_offset;
+  uint64_t finals_offset;
+  uint64_t image_size;
+  // FNV-1a over everything after the header.
+  uint64_t checksum;
+};
+
+constexpr char kMagic[8] = {'R', 'E', 'G', 'E', 'X', 'D', 'F', 'A'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+uint64_t Checksum(const char *data, size_t size) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+size_t AlignUp(size_t offset) { return (offset + 7) & ~size_t{7}; }
+
+} // namespace
+
+DenseDFA::DenseDFA() {
+  static const auto empty = std::make_shared<const Tables>();
+  SetTables(empty);
+}
+
+void DenseDFA::SetTables(std::shared_ptr<const Tables> tables) {
+  classes_ = tables->classes.data();
+  table_ = tables->table.data();
+  finals_ = tables->finals.data();
+  state_count_ = static_cast<int>(tables->finals.size());
+  storage_ = std::move(tables);
+}
+
+DenseDFA::DenseDFA(const NFA &dfa) {
+  CompiledNFA compiled(dfa);
+  const std::vector<char> &alphabet = compiled.GetAlphabet();
+  int n = compiled.StateCount();
+
+  for (int state = 0; state < n; ++state) {
+    for (int e = compiled.EdgesBegin(state); e < compiled.EdgesEnd(state);
+         ++e) {
+      if (compiled.EdgeSymbol(e) == CompiledNFA::kEpsilon ||
+          (e > compiled.EdgesBegin(state) &&
+           compiled.EdgeSymbol(e) == compiled.EdgeSymbol(e - 1))) {
+        throw std::runtime_error("DenseDFA requires a deterministic automaton");
+      }
+    }
+  }
+
+  auto tables = std::make_shared<Tables>();
+
+  // Dense state i + 1 is compiled state i; symbols with identical columns
+  // share a class.
+  std::map<std::vector<int32_t>, int> class_of_column;
+  std::vector<std::vector<int32_t>> columns;
+  std::vector<int32_t> dead_column(n, kDeadState);
+  class_of_column[dead_column] = 0;
+  columns.push_back(dead_column);
+
+  for (char symbol : alphabet) {
+    std::vector<int32_t> column(n);
+    for (int state = 0; state < n; ++state) {
+      column[state] = compiled.FindTarget(state, symbol) + 1;
+    }
+
+    auto it = class_of_column.emplace(column, static_cast<int>(columns.size()));
+    if (it.second) {
+      columns.push_back(std::move(column));
+    }
+    tables->classes[static_cast<unsigned char>(symbol)] =
+        static_cast<uint8_t>(it.first->second);
+  }
+
+  class_count_ = static_cast<int>(columns.size());
+  tables->table.assign(static_cast<size_t>(n + 1) * class_count_, kDeadState);
+  tables->finals.assign(n + 1, 0);
+
+  for (int state = 0; state < n; ++state) {
+    tables->finals[state + 1] = compiled.IsFinal(state);
+    for (int c = 0; c < class_count_; ++c) {
+      tables->table[static_cast<size_t>(state + 1) * class_count_ + c] =
+          columns[c][state];
+    }
+  }
+
+  SetTables(std::move(tables));
+  start_ = compiled.GetStart() + 1;
+}
+
+int64_t DenseDFA::ContainsPrefix(std::string_view str) const {
+  const int32_t *table = table_;
+  const uint8_t *classes = classes_;
+  const uint8_t *finals = finals_;
+  const size_t width = class_count_;
+
+  int state = start_;
+  int64_t longest_match = finals[state] ? 0 : -1;
+
+  for (size_t i = 0; i < str.size(); ++i) {
+    state = table[state * width + classes[static_cast<unsigned char>(str[i])]];
+    if (state == kDeadState) {
+      break;
+    }
+    if (finals[state]) {
+      longest_match = static_cast<int64_t>(i + 1);
+    }
+  }
+
+  return longest_match;
+}
+
+bool DenseDFA::Matches(std::string_view str) const {
+  const int32_t *table = table_;
+  const uint8_t *classes = classes_;
+  const size_t width = class_count_;
+  const auto *data = reinterpret_cast<const unsigned char *>(str.data());
+  const size_t size = str.size();
+
+  // The dead state is absorbing, so it is enough to look for it once per
+  // block.
+  size_t state = start_;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    state = table[state * width + classes[data[i]]];
+    state = table[state * width + classes[data[i + 1]]];
+    state = table[state * width + classes[data[i + 2]]];
+    state = table[state * width + classes[data[i + 3]]];
+    state = table[state * width + classes[data[i + 4]]];
+    state = table[state * width + classes[data[i + 5]]];
+    state = table[state * width + classes[data[i + 6]]];
+    state = table[state * width + classes[data[i + 7]]];
+    if (state == kDeadState) {
+      return false;
+    }
+  }
+  for (; i < size; ++i) {
+    state = table[state * width + classes[data[i]]];
+  }
+
+  return finals_[state];
+}
+
+std::string DenseDFA::Serialize() const {
+  size_t table_size = static_cast<size_t>(state_count_) * class_count_;
+
+  ImageHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byte_order = kByteOrderMark;
+  header.version = kFormatVersion;
+  header.state_count = static_cast<uint32_t>(state_count_);
+  header.class_count = static_cast<uint32_t>(class_count_);
+  header.start = start_;
+  header.classes_offset = AlignUp(sizeof(ImageHeader));
+  header.table_offset = AlignUp(header.classes_offset + 256);
+  header.finals_offset =
+      AlignUp(header.table_offset + table_size * sizeof(int32_t));
+  header.image_size = AlignUp(header.finals_offset + state_count_);
+
+  std::string image(header.image_size, '\0');
+  std::memcpy(image.data() + header.classes_offset, classes_, 256);
+  std::memcpy(image.data() + header.table_offset, table_,
+              table_size * sizeof(int32_t));
+  std::memcpy(image.data() + header.finals_offset, finals_, state_count_);
+
+  header.checksum = Checksum(image.data() + sizeof(ImageHeader),
+                             image.size() - sizeof(ImageHeader));
+  std::memcpy(image.data(), &header, sizeof(ImageHeader));
+  return image;
+}
+
+void DenseDFA::Save(const std::string &path) const {
+  std::string image = Serialize();
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(image.data(), static_cast<std::streamsize>(image.size()));
+  if (!out) {
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+DenseDFA DenseDFA::FromImage(std::string_view image,
+                             std::shared_ptr<const void> owner, bool verify) {
+  ImageHeader header;
+  if (image.size() < sizeof(ImageHeader)) {
+    throw std::runtime_error("DenseDFA image is truncated");
+  }
+  std::memcpy(&header, image.data(), sizeof(ImageHeader));
+
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("Not a DenseDFA image");
+  }
+  if (header.byte_order != kByteOrderMark) {
+    throw std::runtime_error("DenseDFA image has a different byte order");
+  }
+  if (header.version != kFormatVersion) {
+    throw std::runtime_error("Unsupported DenseDFA image version " +
+                             std::to_string(header.version));
+  }
+  if (reinterpret_cast<uintptr_t>(image.data()) % alignof(int32_t) != 0) {
+    throw std::runtime_error("DenseDFA image is misaligned");
+  }
+
+  // The header is untrusted: each array is checked to lie inside the image
+  // before any offsets are added, so no sum can wrap around.
+  uint64_t size = image.size();
+  auto fits = [size](uint64_t offset, uint64_t length) {
+    return offset <= size && length <= size - offset;
+  };
+  uint64_t table_size =
+      static_cast<uint64_t>(header.state_count) * header.class_count;
+  uint64_t table_bytes = table_size * sizeof(int32_t);
+  if (header.state_count == 0 || header.class_count == 0 ||
+      header.class_count > 256 || header.image_size != size ||
+      header.start < 0 ||
+      static_cast<uint32_t>(header.start) >= header.state_count ||
+      header.classes_offset % 8 != 0 || header.table_offset % 8 != 0 ||
+      header.classes_offset < sizeof(ImageHeader) ||
+      !fits(header.classes_offset, 256) ||
+      !fits(header.table_offset, table_bytes) ||
+      !fits(header.finals_offset, header.state_count) ||
+      header.classes_offset + 256 > header.table_offset ||
+      header.table_offset + table_bytes > header.finals_offset) {
+    throw std::runtime_error("DenseDFA image is malformed");
+  }
+
+  DenseDFA dfa;
+  dfa.classes_ =
+      reinterpret_cast<const uint8_t *>(image.data() + header.classes_offset);
+  dfa.table_ =
+      reinterpret_cast<const int32_t *>(image.data() + header.table_offset);
+  dfa.finals_ =
+      reinterpret_cast<const uint8_t *>(image.data() + header.finals_offset);
+  dfa.state_count_ = static_cast<int>(header.state_count);
+  dfa.class_count_ = static_cast<int>(header.class_count);
+  dfa.start_ = header.start;
+  dfa.storage_ = std::move(owner);
+
+  if (verify) {
+    if (Checksum(image.data() + sizeof(ImageHeader),
+                 image.size() - sizeof(ImageHeader)) != header.checksum) {
+      throw std::runtime_error("DenseDFA image checksum mismatch");
+    }
+    for (int byte = 0; byte < 256; ++byte) {
+      if (dfa.classes_[byte] >= header.class_count) {
+        throw std::runtime_error("DenseDFA image is malformed");
+      }
+    }
+    for (uint64_t i = 0; i < table_size; ++i) {
+      if (dfa.table_[i] < 0 ||
+          static_cast<uint32_t>(dfa.table_[i]) >= header.state_count) {
+        throw std::runtime_error("DenseDFA image is malformed");
+      }
+    }
+  }
+
+  return dfa;
+}
+
+DenseDFA DenseDFA::Load(const std::string &path, bool verify) {
+  auto file = std::make_shared<const MappedFile>(path);
+  std::string_view image = file->View();
+  return FromImage(image, std::move(file), verify);
+}
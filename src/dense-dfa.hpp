@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nfa.hpp"
+
+// Flat transition table exported from a deterministic NFA (for example the
+// result of ToMinimal). Input bytes are first mapped to symbol classes:
+// alphabet symbols that move every state to the same place share a class,
+// and class 0 holds all bytes that always lead to the dead state. The next
+// state is table[state * ClassCount() + class]; state 0 is the dead state
+// and state s + 1 is GetStates()[s] of the source automaton.
+//
+// The tables are immutable and shared between copies. They either live in
+// memory built by the constructor or directly in a serialized image (see
+// Serialize and Load), in which case nothing is copied or decoded.
+class DenseDFA {
+  struct Tables {
+    std::array<uint8_t, 256> classes{};
+    std::vector<int32_t> table{kDeadState};
+    std::vector<uint8_t> finals{0};
+  };
+
+  // Keeps the memory behind the views below alive.
+  std::shared_ptr<const void> storage_;
+  const uint8_t *classes_;
+  const int32_t *table_;
+  const uint8_t *finals_;
+  int state_count_ = 1;
+  int class_count_ = 1;
+  int start_ = kDeadState;
+
+  void SetTables(std::shared_ptr<const Tables> tables);
+
+public:
+  static constexpr int kDeadState = 0;
+  static constexpr uint32_t kFormatVersion = 1;
+
+  DenseDFA();
+  explicit DenseDFA(const NFA &dfa);
+
+  int StateCount() const { return state_count_; }
+
+  int ClassCount() const { return class_count_; }
+
+  int GetStart() const { return start_; }
+
+  int GetClass(unsigned char byte) const { return classes_[byte]; }
+
+  int Next(int state, unsigned char byte) const {
+    return table_[static_cast<size_t>(state) * class_count_ + classes_[byte]];
+  }
+
+  bool IsFinal(int state) const { return finals_[state]; }
+
+  // Same result as NFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const;
+  bool Matches(std::string_view str) const;
+
+  // Versioned, checksummed image whose arrays are addressed by offsets from
+  // its start, so it can be used in place.
+  std::string Serialize() const;
+  void Save(const std::string &path) const;
+
+  // Uses `image` in place; `owner` keeps its memory alive. The image must be
+  // 4-byte aligned. With `verify` the checksum and every transition are
+  // checked; otherwise only the header is. Throws std::runtime_error for
+  // malformed images.
+  static DenseDFA FromImage(std::string_view image,
+                            std::shared_ptr<const void> owner,
+                            bool verify = true);
+  // Memory-maps a saved image, so processes loading the same file share its
+  // pages.
+  static DenseDFA Load(const std::string &path, bool verify = true);
+};
@@ -0,0 +1,198 @@
+#include "derivative-dfa.hpp"
+
+#include <algorithm>
+#include <queue>
+
+DerivativeDFA::DerivativeDFA(const std::string &regex) {
+  ExprId root = RightNest(pool_.Parse(regex));
+
+  for (ExprId id = 0; id < static_cast<ExprId>(pool_.Size()); ++id) {
+    if (pool_.GetKind(id) == RegexExprPool::Kind::Symbol) {
+      alphabet_.push_back(pool_.GetSymbol(id));
+    }
+  }
+  std::sort(alphabet_.begin(), alphabet_.end());
+  classes_.fill(-1);
+  for (size_t c = 0; c < alphabet_.size(); ++c) {
+    classes_[static_cast<unsigned char>(alphabet_[c])] = static_cast<int>(c);
+  }
+
+  AddState({});
+  start_ = root == RegexExprPool::kEmpty ? kDead : AddState({root});
+}
+
+RegexExprPool::ExprId DerivativeDFA::RightNest(ExprId expr) {
+  // Parse nests long concatenations to the left. The derivative of a
+  // concatenation recurses into its left operand, so the spine is turned
+  // to the right once up front.
+  switch (pool_.GetKind(expr)) {
+  case RegexExprPool::Kind::Union: {
+    ExprId result = RegexExprPool::kEmpty;
+    for (ExprId alternative : pool_.Alternatives(expr)) {
+      result = pool_.Union(result, RightNest(alternative));
+    }
+    return result;
+  }
+  case RegexExprPool::Kind::Concat: {
+    std::vector<ExprId> factors = pool_.Factors(expr);
+    ExprId result = RegexExprPool::kOne;
+    for (auto it = factors.rbegin(); it != factors.rend(); ++it) {
+      result = pool_.Concat(RightNest(*it), result);
+    }
+    return result;
+  }
+  case RegexExprPool::Kind::Star:
+    return pool_.Star(RightNest(pool_.Left(expr)));
+  default:
+    return expr;
+  }
+}
+
+const std::vector<RegexExprPool::ExprId> &
+DerivativeDFA::Derivative(ExprId expr, char symbol) const {
+  uint64_t key = static_cast<uint64_t>(expr) << 8 |
+                 static_cast<unsigned char>(symbol);
+  auto cached = derivatives_.find(key);
+  if (cached != derivatives_.end()) {
+    return cached->second;
+  }
+
+  std::vector<ExprId> result;
+  switch (pool_.GetKind(expr)) {
+  case RegexExprPool::Kind::Empty:
+  case RegexExprPool::Kind::One:
+    break;
+  case RegexExprPool::Kind::Symbol:
+    if (pool_.GetSymbol(expr) == symbol) {
+      result.push_back(RegexExprPool::kOne);
+    }
+    break;
+  case RegexExprPool::Kind::Union:
+    for (ExprId alternative : pool_.Alternatives(expr)) {
+      const std::vector<ExprId> &part = Derivative(alternative, symbol);
+      result.insert(result.end(), part.begin(), part.end());
+    }
+    break;
+  case RegexExprPool::Kind::Concat:
+    // d(xy) = d(x)y, plus d(y) when x is nullable. The right spine is
+    // walked in a loop.
+    while (pool_.GetKind(expr) == RegexExprPool::Kind::Concat) {
+      ExprId left = pool_.Left(expr);
+      ExprId right = pool_.Right(expr);
+      for (ExprId part : Derivative(left, symbol)) {
+        result.push_back(pool_.Concat(part, right));
+      }
+      if (!pool_.IsNullable(left)) {
+        expr = RegexExprPool::kEmpty;
+        break;
+      }
+      expr = right;
+    }
+    {
+      const std::vector<ExprId> &part = Derivative(expr, symbol);
+      result.insert(result.end(), part.begin(), part.end());
+    }
+    break;
+  case RegexExprPool::Kind::Star:
+    // d(x*) = d(x)x*
+    for (ExprId part : Derivative(pool_.Left(expr), symbol)) {
+      result.push_back(pool_.Concat(part, expr));
+    }
+    break;
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return derivatives_.emplace(key, std::move(result)).first->second;
+}
+
+int DerivativeDFA::AddState(const std::vector<int> &set) const {
+  auto [id, inserted] = states_.Intern(set);
+  if (inserted) {
+    transitions_.resize(transitions_.size() + alphabet_.size(),
+                        id == kDead ? kDead : kUnknown);
+    finals_.push_back(std::any_of(set.begin(), set.end(), [this](ExprId expr) {
+      return pool_.IsNullable(expr);
+    }));
+  }
+  return id;
+}
+
+int DerivativeDFA::Next(int state, int symbol_class) const {
+  size_t index = static_cast<size_t>(state) * alphabet_.size() + symbol_class;
+  if (transitions_[index] != kUnknown) {
+    return transitions_[index];
+  }
+
+  std::vector<int> next;
+  for (const int *it = states_.Begin(state); it != states_.End(state); ++it) {
+    const std::vector<ExprId> &part = Derivative(*it, alphabet_[symbol_class]);
+    next.insert(next.end(), part.begin(), part.end());
+  }
+  std::sort(next.begin(), next.end());
+  next.erase(std::unique(next.begin(), next.end()), next.end());
+
+  int target = AddState(next);
+  transitions_[index] = target;
+  return target;
+}
+
+int64_t DerivativeDFA::ContainsPrefix(std::string_view str) const {
+  int state = start_;
+  int64_t longest_match = finals_[state] ? 0 : -1;
+
+  for (size_t i = 0; i < str.size() && state != kDead; ++i) {
+    int symbol_class = classes_[static_cast<unsigned char>(str[i])];
+    state = symbol_class < 0 ? kDead : Next(state, symbol_class);
+    if (finals_[state]) {
+      longest_match = static_cast<int64_t>(i + 1);
+    }
+  }
+
+  return longest_match;
+}
+
+bool DerivativeDFA::Matches(std::string_view str) const {
+  int state = start_;
+  for (size_t i = 0; i < str.size() && state != kDead; ++i) {
+    int symbol_class = classes_[static_cast<unsigned char>(str[i])];
+    state = symbol_class < 0 ? kDead : Next(state, symbol_class);
+  }
+  return finals_[state];
+}
+
+NFA DerivativeDFA::ToDFA() const {
+  NFA result;
+  std::unordered_map<int, int> state_ids;
+  std::queue<int> pending;
+
+  state_ids[start_] = result.CreateState(finals_[start_])->id;
+  result.start_id_ = state_ids[start_];
+  pending.push(start_);
+
+  while (!pending.empty()) {
+    int state = pending.front();
+    pending.pop();
+
+    for (size_t c = 0; c < alphabet_.size(); ++c) {
+      int target = Next(state, static_cast<int>(c));
+      if (target == kDead) {
+        continue;
+      }
+      auto [it, inserted] = state_ids.emplace(target, 0);
+      if (inserted) {
+        it->second = result.CreateState(finals_[target])->id;
+        pending.push(target);
+      }
+      result.AddTransition(state_ids[state], alphabet_[c], it->second);
+    }
+  }
+
+  for (const auto &state : result.states_) {
+    if (state->is_final) {
+      result.end_id_ = state->id;
+      break;
+    }
+  }
+  return result;
+}
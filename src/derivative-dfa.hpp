@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "nfa.hpp"
+#include "regex-expr.hpp"
+#include "subset-interner.hpp"
+
+// DFA built from Antimirov partial derivatives of the regex, without an NFA.
+// A state is the set of partial derivatives of the regex by the input read
+// so far; it accepts when one of them matches the empty word. States are
+// interned as sorted sets of expression ids, and both the derivatives of
+// single expressions and the transitions between states are memoized, so
+// matching only builds the states the input reaches.
+//
+// Matching fills the caches, so a DerivativeDFA must not be used by several
+// threads at once.
+class DerivativeDFA {
+  using ExprId = RegexExprPool::ExprId;
+
+  static constexpr int kUnknown = -1;
+  // The empty set, interned first.
+  static constexpr int kDead = 0;
+
+  mutable RegexExprPool pool_;
+  std::vector<char> alphabet_;
+  // Index into alphabet_, or -1 for bytes that always lead to kDead.
+  std::array<int, 256> classes_;
+  int start_ = kDead;
+
+  mutable SubsetInterner states_;
+  mutable std::vector<int> transitions_;
+  mutable std::vector<char> finals_;
+  mutable std::unordered_map<uint64_t, std::vector<ExprId>> derivatives_;
+
+  ExprId RightNest(ExprId expr);
+  const std::vector<ExprId> &Derivative(ExprId expr, char symbol) const;
+  int AddState(const std::vector<int> &set) const;
+  int Next(int state, int symbol_class) const;
+
+public:
+  explicit DerivativeDFA(const std::string &regex);
+
+  // Same result as NFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const;
+  bool Matches(std::string_view str) const;
+
+  // States built so far, including the dead state.
+  int CachedStates() const { return states_.Size(); }
+
+  // Builds every reachable state and returns the automaton in the form
+  // NFA::ToDFA produces, to be compared with or used in place of it.
+  NFA ToDFA() const;
+};
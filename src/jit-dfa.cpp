@@ -0,0 +1,212 @@
+#include "jit-dfa.hpp"
+
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#define REGEX_JIT_X86_64 1
+#endif
+
+namespace {
+
+// Minimal x86-64 assembler for the instructions the matcher needs. Jumps
+// always use 32-bit displacements and are patched once all labels are known.
+class Assembler {
+  std::vector<uint8_t> code_;
+  std::vector<std::pair<size_t, int>> fixups_;
+  std::vector<size_t> labels_;
+
+  void Imm32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      code_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+
+  void Bytes(std::initializer_list<uint8_t> bytes) {
+    code_.insert(code_.end(), bytes);
+  }
+
+  void Rel32(int label) {
+    fixups_.emplace_back(code_.size(), label);
+    Imm32(0);
+  }
+
+public:
+  explicit Assembler(int label_count) : labels_(label_count, 0) {}
+
+  void Bind(int label) { labels_[label] = code_.size(); }
+
+  // mov rdx, rdi; add rsi, rdi; mov rax, -1
+  void Prologue() {
+    Bytes({0x48, 0x89, 0xFA});
+    Bytes({0x48, 0x01, 0xFE});
+    Bytes({0x48, 0xC7, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF});
+  }
+
+  // mov rax, rdi; sub rax, rdx
+  void RecordMatch() {
+    Bytes({0x48, 0x89, 0xF8});
+    Bytes({0x48, 0x29, 0xD0});
+  }
+
+  // cmp rdi, rsi; jae label
+  void JumpIfAtEnd(int label) {
+    Bytes({0x48, 0x39, 0xF7});
+    Bytes({0x0F, 0x83});
+    Rel32(label);
+  }
+
+  // movzx ecx, byte [rdi]; inc rdi
+  void LoadNextByte() {
+    Bytes({0x0F, 0xB6, 0x0F});
+    Bytes({0x48, 0xFF, 0xC7});
+  }
+
+  // cmp ecx, byte; je label
+  void JumpIfByte(int byte, int label) {
+    Bytes({0x81, 0xF9});
+    Imm32(static_cast<uint32_t>(byte));
+    Bytes({0x0F, 0x84});
+    Rel32(label);
+  }
+
+  // mov r8d, ecx; sub r8d, low; cmp r8d, high - low; jbe label
+  void JumpIfInRange(int low, int high, int label) {
+    Bytes({0x41, 0x89, 0xC8});
+    Bytes({0x41, 0x81, 0xE8});
+    Imm32(static_cast<uint32_t>(low));
+    Bytes({0x41, 0x81, 0xF8});
+    Imm32(static_cast<uint32_t>(high - low));
+    Bytes({0x0F, 0x86});
+    Rel32(label);
+  }
+
+  void Jump(int label) {
+    code_.push_back(0xE9);
+    Rel32(label);
+  }
+
+  void Return() { code_.push_back(0xC3); }
+
+  std::vector<uint8_t> Finish() {
+    for (const auto &[offset, label] : fixups_) {
+      auto displacement =
+          static_cast<int32_t>(labels_[label] - (offset + 4));
+      std::memcpy(code_.data() + offset, &displacement, 4);
+    }
+    return std::move(code_);
+  }
+};
+
+} // namespace
+
+JitDFA::JitDFA(const NFA &dfa) : dfa_(dfa) {
+#ifdef REGEX_JIT_X86_64
+  std::vector<uint8_t> code = EmitX86_64(dfa_);
+
+  void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return;
+  }
+  std::memcpy(memory, code.data(), code.size());
+  if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, code.size());
+    return;
+  }
+
+  code_ = memory;
+  code_size_ = code.size();
+  function_ = reinterpret_cast<MatchFunction>(memory);
+#endif
+}
+
+// int64_t match(const unsigned char *data [rdi], size_t size [rsi]):
+// rdi walks the input, rsi is its end, rdx its start and rax the length of
+// the longest accepted prefix so far. Label s is the block of dense state
+// s; label 0, the dead state, is the exit.
+std::vector<uint8_t> JitDFA::EmitX86_64(const DenseDFA &dfa) {
+  constexpr int kExit = DenseDFA::kDeadState;
+  Assembler assembler(dfa.StateCount());
+
+  assembler.Prologue();
+  assembler.Jump(dfa.GetStart());
+
+  for (int state = 1; state < dfa.StateCount(); ++state) {
+    assembler.Bind(state);
+    if (dfa.IsFinal(state)) {
+      assembler.RecordMatch();
+    }
+    assembler.JumpIfAtEnd(kExit);
+    assembler.LoadNextByte();
+
+    // Maximal runs of consecutive bytes with the same target.
+    int byte = 0;
+    while (byte < 256) {
+      int target = dfa.Next(state, static_cast<unsigned char>(byte));
+      int end = byte + 1;
+      while (end < 256 &&
+             dfa.Next(state, static_cast<unsigned char>(end)) == target) {
+        ++end;
+      }
+      if (target != DenseDFA::kDeadState) {
+        if (end - byte == 1) {
+          assembler.JumpIfByte(byte, target);
+        } else {
+          assembler.JumpIfInRange(byte, end - 1, target);
+        }
+      }
+      byte = end;
+    }
+    assembler.Jump(kExit);
+  }
+
+  assembler.Bind(kExit);
+  assembler.Return();
+  return assembler.Finish();
+}
+
+void JitDFA::Release() {
+#ifdef REGEX_JIT_X86_64
+  if (code_ != nullptr) {
+    munmap(code_, code_size_);
+  }
+#endif
+  code_ = nullptr;
+  code_size_ = 0;
+  function_ = nullptr;
+}
+
+JitDFA::JitDFA(JitDFA &&other) noexcept
+    : dfa_(std::move(other.dfa_)), code_(std::exchange(other.code_, nullptr)),
+      code_size_(std::exchange(other.code_size_, 0)),
+      function_(std::exchange(other.function_, nullptr)) {}
+
+JitDFA &JitDFA::operator=(JitDFA &&other) noexcept {
+  if (this != &other) {
+    Release();
+    dfa_ = std::move(other.dfa_);
+    code_ = std::exchange(other.code_, nullptr);
+    code_size_ = std::exchange(other.code_size_, 0);
+    function_ = std::exchange(other.function_, nullptr);
+  }
+  return *this;
+}
+
+JitDFA::~JitDFA() { Release(); }
+
+int64_t JitDFA::ContainsPrefix(std::string_view str) const {
+  if (function_ != nullptr) {
+    return function_(reinterpret_cast<const unsigned char *>(str.data()),
+                     str.size());
+  }
+  return dfa_.ContainsPrefix(str);
+}
+
+bool JitDFA::Matches(std::string_view str) const {
+  if (function_ != nullptr) {
+    return ContainsPrefix(str) == static_cast<int64_t>(str.size());
+  }
+  return dfa_.Matches(str);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "dense-dfa.hpp"
+
+// DFA compiled to native code at runtime. On x86-64 every state becomes a
+// block of compare/jump instructions over byte ranges in an executable
+// mapping; elsewhere, or if the mapping can't be made executable, matching
+// falls back to the DenseDFA tables. Both paths give the same results.
+class JitDFA {
+  using MatchFunction = int64_t (*)(const unsigned char *data, size_t size);
+
+  DenseDFA dfa_;
+  void *code_ = nullptr;
+  size_t code_size_ = 0;
+  MatchFunction function_ = nullptr;
+
+  static std::vector<uint8_t> EmitX86_64(const DenseDFA &dfa);
+  void Release();
+
+public:
+  explicit JitDFA(const NFA &dfa);
+
+  JitDFA(JitDFA &&other) noexcept;
+  JitDFA &operator=(JitDFA &&other) noexcept;
+
+  JitDFA(const JitDFA &) = delete;
+  JitDFA &operator=(const JitDFA &) = delete;
+
+  ~JitDFA();
+
+  // True if matching runs native code rather than the table fallback.
+  bool IsCompiled() const { return function_ != nullptr; }
+
+  size_t CodeSize() const { return code_size_; }
+
+  // Same results as NFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const;
+  bool Matches(std::string_view str) const;
+};
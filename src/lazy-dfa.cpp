@@ -0,0 +1,126 @@
+#include "lazy-dfa.hpp"
+
+#include <mutex>
+
+LazyDFA::LazyDFA(const NFA &nfa, size_t memory_limit)
+    : nfa_(nfa), memory_limit_(memory_limit) {
+  classes_.fill(-1);
+  for (char symbol : nfa_.GetAlphabet()) {
+    classes_[static_cast<unsigned char>(symbol)] = class_count_++;
+  }
+
+  Flush();
+  flushes_ = 0;
+}
+
+int LazyDFA::AddState(const std::vector<int> &set) const {
+  auto [id, inserted] = subsets_.Intern(set);
+  if (inserted) {
+    transitions_.resize(transitions_.size() + class_count_, kUnknown);
+    finals_.push_back(nfa_.ContainsFinalState(set));
+  }
+  return id;
+}
+
+void LazyDFA::Flush() const {
+  subsets_.Clear();
+  transitions_.clear();
+  finals_.clear();
+  ++generation_;
+  ++flushes_;
+
+  // The start state is always state 0.
+  std::vector<int> start;
+  if (nfa_.GetStart() >= 0) {
+    start.assign(nfa_.ClosureBegin(nfa_.GetStart()),
+                 nfa_.ClosureEnd(nfa_.GetStart()));
+  }
+  AddState(start);
+}
+
+size_t LazyDFA::MemoryUsage() const {
+  return subsets_.MemoryUsage() + transitions_.capacity() * sizeof(int) +
+         finals_.capacity();
+}
+
+int LazyDFA::ComputeTransition(std::shared_lock<std::shared_mutex> &lock,
+                               int state, int symbol_class) const {
+  std::vector<int> current(subsets_.Begin(state), subsets_.End(state));
+  char symbol = nfa_.GetAlphabet()[symbol_class];
+
+  while (true) {
+    lock.unlock();
+
+    int next;
+    size_t generation;
+    {
+      std::unique_lock<std::shared_mutex> exclusive(mutex_);
+
+      int from = subsets_.Find(current);
+      if (from == -1 || MemoryUsage() > memory_limit_) {
+        if (from != -1) {
+          Flush();
+        }
+        from = AddState(current);
+      }
+
+      next = transitions_[static_cast<size_t>(from) * class_count_ +
+                          symbol_class];
+      if (next == kUnknown) {
+        nfa_.FindReachableInOneStep(current.data(),
+                                    current.data() + current.size(), symbol,
+                                    scratch_, step_scratch_);
+        next = scratch_.empty() ? kDead : AddState(scratch_);
+        transitions_[static_cast<size_t>(from) * class_count_ +
+                     symbol_class] = next;
+      }
+      generation = generation_;
+    }
+
+    lock.lock();
+    // Another thread may have flushed the cache before the shared lock was
+    // reacquired, in which case `next` no longer names the right state.
+    if (generation == generation_) {
+      return next;
+    }
+  }
+}
+
+int64_t LazyDFA::ContainsPrefix(std::string_view str) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+
+  int state = 0;
+  int64_t longest_match = finals_[state] ? 0 : -1;
+
+  for (size_t i = 0; i < str.size(); ++i) {
+    int symbol_class = classes_[static_cast<unsigned char>(str[i])];
+    if (symbol_class < 0) {
+      break;
+    }
+
+    int next =
+        transitions_[static_cast<size_t>(state) * class_count_ + symbol_class];
+    if (next == kUnknown) {
+      next = ComputeTransition(lock, state, symbol_class);
+    }
+    if (next == kDead) {
+      break;
+    }
+
+    state = next;
+    if (finals_[state]) {
+      longest_match = static_cast<int64_t>(i + 1);
+    }
+  }
+
+  return longest_match;
+}
+
+bool LazyDFA::Matches(std::string_view str) const {
+  return ContainsPrefix(str) == static_cast<int64_t>(str.size());
+}
+
+int LazyDFA::CachedStates() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return subsets_.Size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "compiled-nfa.hpp"
+#include "nfa.hpp"
+#include "subset-interner.hpp"
+
+// DFA that is determinized on the fly while matching. Only subsets that are
+// actually visited are materialized; transitions are cached per state in a
+// row of symbol classes. When the cache outgrows its memory limit it is
+// flushed and rebuilt from the start state.
+//
+// A LazyDFA can be shared by many threads: matching holds a shared lock and
+// only takes the exclusive lock to add a missing transition.
+class LazyDFA {
+  static constexpr int kUnknown = -1;
+  static constexpr int kDead = -2;
+
+  CompiledNFA nfa_;
+  std::array<int, 256> classes_;
+  int class_count_ = 0;
+  size_t memory_limit_;
+
+  mutable std::shared_mutex mutex_;
+  mutable SubsetInterner subsets_;
+  mutable std::vector<int> transitions_;
+  mutable std::vector<char> finals_;
+  mutable std::vector<int> scratch_;
+  mutable CompiledNFA::StepScratch step_scratch_;
+  mutable size_t generation_ = 0;
+  mutable std::atomic<size_t> flushes_{0};
+
+  int AddState(const std::vector<int> &set) const;
+  void Flush() const;
+  size_t MemoryUsage() const;
+  int ComputeTransition(std::shared_lock<std::shared_mutex> &lock, int state,
+                        int symbol_class) const;
+
+public:
+  static constexpr size_t kDefaultMemoryLimit = size_t{8} << 20;
+
+  explicit LazyDFA(const NFA &nfa, size_t memory_limit = kDefaultMemoryLimit);
+
+  LazyDFA(const LazyDFA &) = delete;
+  LazyDFA &operator=(const LazyDFA &) = delete;
+
+  // Same result as NFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const;
+  bool Matches(std::string_view str) const;
+
+  int CachedStates() const;
+  size_t CacheFlushes() const { return flushes_.load(); }
+};
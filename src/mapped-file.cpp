@@ -0,0 +1,66 @@
+#include "mapped-file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::runtime_error("Cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    int error = errno;
+    close(fd);
+    throw std::runtime_error("Cannot stat " + path + ": " +
+                             std::strerror(error));
+  }
+
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ == 0) {
+    close(fd);
+    return;
+  }
+
+  void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  int error = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    throw std::runtime_error("Cannot map " + path + ": " +
+                             std::strerror(error));
+  }
+
+  madvise(data, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char *>(data);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. The kernel is told that the
+// mapping is read sequentially, so it can read ahead and drop pages behind
+// the scan. Throws std::runtime_error if the file can't be mapped.
+class MappedFile {
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+
+public:
+  explicit MappedFile(const std::string &path);
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile();
+
+  std::string_view View() const { return {data_, size_}; }
+
+  size_t Size() const { return size_; }
+};
@@ -0,0 +1,352 @@
+#include "minimizer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+struct SignatureHash {
+  size_t operator()(const std::vector<int> &signature) const {
+    uint64_t hash = 14695981039346656037ull;
+    for (int value : signature) {
+      hash ^= static_cast<uint32_t>(value);
+      hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+// Row `state` of the table holds the target of every alphabet symbol, or -1.
+void FillTransitionTable(const CompiledNFA &dfa, int begin, int end,
+                         std::vector<int> &delta) {
+  const std::vector<char> &alphabet = dfa.GetAlphabet();
+  size_t k = alphabet.size();
+  for (int state = begin; state < end; ++state) {
+    for (size_t a = 0; a < k; ++a) {
+      delta[state * k + a] = dfa.FindTarget(state, alphabet[a]);
+    }
+  }
+}
+
+} // namespace
+
+int DFAMinimizer::CanonicalizeBlocks(std::vector<int> &blocks) {
+  std::unordered_map<int, int> renumbered;
+  for (int &block : blocks) {
+    auto it = renumbered.emplace(block, static_cast<int>(renumbered.size()));
+    block = it.first->second;
+  }
+  return static_cast<int>(renumbered.size());
+}
+
+std::vector<int>
+DFAMinimizer::Hopcroft(const CompiledNFA &dfa,
+                       const std::vector<int> &initial_blocks) {
+  const std::vector<char> &alphabet = dfa.GetAlphabet();
+  int n = dfa.StateCount();
+  int k = static_cast<int>(alphabet.size());
+
+  // State n is the implicit dead state, which completes the automaton.
+  int total = n + 1;
+  std::vector<int> delta(static_cast<size_t>(total) * k, n);
+  for (int state = 0; state < n; ++state) {
+    for (int a = 0; a < k; ++a) {
+      int target = dfa.FindTarget(state, alphabet[a]);
+      if (target != -1) {
+        delta[static_cast<size_t>(state) * k + a] = target;
+      }
+    }
+  }
+
+  // Predecessors of (target, a) in CSR form.
+  std::vector<int> inverse_offsets(static_cast<size_t>(total) * k + 1, 0);
+  for (size_t i = 0; i < delta.size(); ++i) {
+    ++inverse_offsets[static_cast<size_t>(delta[i]) * k + i % k + 1];
+  }
+  for (size_t i = 1; i < inverse_offsets.size(); ++i) {
+    inverse_offsets[i] += inverse_offsets[i - 1];
+  }
+  std::vector<int> inverse_sources(delta.size());
+  {
+    std::vector<int> fill(inverse_offsets.begin(), inverse_offsets.end() - 1);
+    for (size_t i = 0; i < delta.size(); ++i) {
+      size_t slot = static_cast<size_t>(delta[i]) * k + i % k;
+      inverse_sources[fill[slot]++] = static_cast<int>(i / k);
+    }
+  }
+
+  std::vector<int> block_of(initial_blocks);
+  int block_count = CanonicalizeBlocks(block_of);
+  block_of.push_back(block_count++);
+
+  // Refinable partition: the states of block b are
+  // elements[block_begin[b]..block_end[b]), the first block_marked[b] of
+  // them being marked.
+  std::vector<int> elements(total);
+  std::vector<int> location(total);
+  std::vector<int> block_begin(block_count, 0);
+  std::vector<int> block_end(block_count, 0);
+  std::vector<int> block_marked(block_count, 0);
+
+  for (int state = 0; state < total; ++state) {
+    ++block_end[block_of[state]];
+  }
+  for (int b = 1; b < block_count; ++b) {
+    block_begin[b] = block_end[b - 1];
+    block_end[b] += block_begin[b];
+  }
+  {
+    std::vector<int> fill(block_begin);
+    for (int state = 0; state < total; ++state) {
+      location[state] = fill[block_of[state]]++;
+      elements[location[state]] = state;
+    }
+  }
+
+  std::vector<std::pair<int, int>> worklist;
+  std::vector<char> in_worklist(static_cast<size_t>(block_count) * k, 0);
+
+  auto push_splitter = [&](int block, int a) {
+    in_worklist[static_cast<size_t>(block) * k + a] = 1;
+    worklist.emplace_back(block, a);
+  };
+
+  int largest = 0;
+  for (int b = 1; b < block_count; ++b) {
+    if (block_end[b] - block_begin[b] >
+        block_end[largest] - block_begin[largest]) {
+      largest = b;
+    }
+  }
+  for (int b = 0; b < block_count; ++b) {
+    if (b != largest) {
+      for (int a = 0; a < k; ++a) {
+        push_splitter(b, a);
+      }
+    }
+  }
+
+  std::vector<int> predecessors;
+  std::vector<int> touched;
+
+  while (!worklist.empty()) {
+    auto [splitter, a] = worklist.back();
+    worklist.pop_back();
+    in_worklist[static_cast<size_t>(splitter) * k + a] = 0;
+
+    predecessors.clear();
+    for (int i = block_begin[splitter]; i < block_end[splitter]; ++i) {
+      size_t slot = static_cast<size_t>(elements[i]) * k + a;
+      predecessors.insert(predecessors.end(),
+                          inverse_sources.begin() + inverse_offsets[slot],
+                          inverse_sources.begin() + inverse_offsets[slot + 1]);
+    }
+
+    touched.clear();
+    for (int state : predecessors) {
+      int b = block_of[state];
+      int slot = block_begin[b] + block_marked[b]++;
+      int other = elements[slot];
+      std::swap(elements[slot], elements[location[state]]);
+      location[other] = location[state];
+      location[state] = slot;
+      if (block_marked[b] == 1) {
+        touched.push_back(b);
+      }
+    }
+
+    for (int b : touched) {
+      int marked = block_marked[b];
+      block_marked[b] = 0;
+      if (marked == block_end[b] - block_begin[b]) {
+        continue;
+      }
+
+      int split = block_count++;
+      block_begin.push_back(block_begin[b]);
+      block_end.push_back(block_begin[b] + marked);
+      block_marked.push_back(0);
+      in_worklist.resize(static_cast<size_t>(block_count) * k, 0);
+      block_begin[b] += marked;
+      for (int i = block_begin[split]; i < block_end[split]; ++i) {
+        block_of[elements[i]] = split;
+      }
+
+      bool split_is_smaller = marked < block_end[b] - block_begin[b];
+      for (int c = 0; c < k; ++c) {
+        if (in_worklist[static_cast<size_t>(b) * k + c]) {
+          push_splitter(split, c);
+        } else {
+          push_splitter(split_is_smaller ? split : b, c);
+        }
+      }
+    }
+  }
+
+  block_of.pop_back();
+  CanonicalizeBlocks(block_of);
+  return block_of;
+}
+
+std::vector<int> DFAMinimizer::Moore(const CompiledNFA &dfa,
+                                     const std::vector<int> &initial_blocks) {
+  const std::vector<char> &alphabet = dfa.GetAlphabet();
+  int n = dfa.StateCount();
+  int k = static_cast<int>(alphabet.size());
+
+  std::vector<int> delta(static_cast<size_t>(n) * k);
+  FillTransitionTable(dfa, 0, n, delta);
+
+  std::vector<int> blocks(initial_blocks);
+  int block_count = CanonicalizeBlocks(blocks);
+
+  std::vector<int> next_blocks(n);
+  std::vector<int> signature(k + 1);
+  std::unordered_map<std::vector<int>, int, SignatureHash> signature_ids;
+
+  while (true) {
+    signature_ids.clear();
+    for (int state = 0; state < n; ++state) {
+      signature[0] = blocks[state];
+      for (int a = 0; a < k; ++a) {
+        int target = delta[static_cast<size_t>(state) * k + a];
+        signature[a + 1] = target == -1 ? -1 : blocks[target];
+      }
+      auto it = signature_ids.emplace(signature,
+                                      static_cast<int>(signature_ids.size()));
+      next_blocks[state] = it.first->second;
+    }
+
+    blocks.swap(next_blocks);
+    int new_count = static_cast<int>(signature_ids.size());
+    if (new_count == block_count) {
+      break;
+    }
+    block_count = new_count;
+  }
+
+  return blocks;
+}
+
+std::vector<int>
+DFAMinimizer::ParallelMoore(const CompiledNFA &dfa,
+                            const std::vector<int> &initial_blocks,
+                            WorkStealingPool &pool) {
+  int n = dfa.StateCount();
+  size_t k = dfa.GetAlphabet().size();
+  if (n == 0) {
+    return {};
+  }
+
+  // States are cut into ranges for the per-state work and signatures are
+  // sharded by hash for grouping. Within a shard, states are visited in
+  // increasing order, and blocks are finally numbered by their first state,
+  // exactly as the sequential rounds number them.
+  size_t range_count = std::min<size_t>(4 * pool.ThreadCount(), n);
+  size_t shard_count = range_count;
+  auto range_begin = [&](size_t range) {
+    return static_cast<int>(static_cast<size_t>(n) * range / range_count);
+  };
+
+  std::vector<int> delta(static_cast<size_t>(n) * k);
+  pool.ParallelFor(range_count, [&](size_t range) {
+    FillTransitionTable(dfa, range_begin(range), range_begin(range + 1), delta);
+  });
+
+  std::vector<int> blocks(initial_blocks);
+  int block_count = CanonicalizeBlocks(blocks);
+
+  std::vector<uint64_t> hashes(n);
+  std::vector<int> leader_of(n);
+  std::vector<int> next_blocks(n);
+  std::vector<int> leader_rank(n);
+  std::vector<std::vector<int>> shard_members(range_count * shard_count);
+  std::vector<int> leaders_in_range(range_count + 1);
+
+  auto same_signature = [&](int a, int b) {
+    if (blocks[a] != blocks[b]) {
+      return false;
+    }
+    for (size_t i = 0; i < k; ++i) {
+      int target_a = delta[a * k + i];
+      int target_b = delta[b * k + i];
+      if ((target_a == -1 ? -1 : blocks[target_a]) !=
+          (target_b == -1 ? -1 : blocks[target_b])) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  while (true) {
+    pool.ParallelFor(range_count, [&](size_t range) {
+      for (size_t shard = 0; shard < shard_count; ++shard) {
+        shard_members[range * shard_count + shard].clear();
+      }
+      for (int state = range_begin(range); state < range_begin(range + 1);
+           ++state) {
+        uint64_t hash = 14695981039346656037ull;
+        hash = (hash ^ static_cast<uint32_t>(blocks[state])) * 1099511628211ull;
+        for (size_t a = 0; a < k; ++a) {
+          int target = delta[state * k + a];
+          int value = target == -1 ? -1 : blocks[target];
+          hash = (hash ^ static_cast<uint32_t>(value)) * 1099511628211ull;
+        }
+        hashes[state] = hash;
+        shard_members[range * shard_count + (hash >> 32) % shard_count]
+            .push_back(state);
+      }
+    });
+
+    // Every signature lives in one shard; its leader is its smallest state.
+    pool.ParallelFor(shard_count, [&](size_t shard) {
+      auto hash = [&](int state) { return static_cast<size_t>(hashes[state]); };
+      std::unordered_map<int, int, decltype(hash), decltype(same_signature)>
+          leaders(16, hash, same_signature);
+      for (size_t range = 0; range < range_count; ++range) {
+        for (int state : shard_members[range * shard_count + shard]) {
+          leader_of[state] = leaders.emplace(state, state).first->second;
+        }
+      }
+    });
+
+    pool.ParallelFor(range_count, [&](size_t range) {
+      int count = 0;
+      for (int state = range_begin(range); state < range_begin(range + 1);
+           ++state) {
+        count += leader_of[state] == state;
+      }
+      leaders_in_range[range + 1] = count;
+    });
+    for (size_t range = 0; range < range_count; ++range) {
+      leaders_in_range[range + 1] += leaders_in_range[range];
+    }
+    int new_count = leaders_in_range[range_count];
+
+    pool.ParallelFor(range_count, [&](size_t range) {
+      int rank = leaders_in_range[range];
+      for (int state = range_begin(range); state < range_begin(range + 1);
+           ++state) {
+        if (leader_of[state] == state) {
+          leader_rank[state] = rank++;
+        }
+      }
+    });
+    pool.ParallelFor(range_count, [&](size_t range) {
+      for (int state = range_begin(range); state < range_begin(range + 1);
+           ++state) {
+        next_blocks[state] = leader_rank[leader_of[state]];
+      }
+    });
+
+    blocks.swap(next_blocks);
+    if (new_count == block_count) {
+      break;
+    }
+    block_count = new_count;
+  }
+
+  return blocks;
+}
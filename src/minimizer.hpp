@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "compiled-nfa.hpp"
+#include "thread-pool.hpp"
+
+// Partition refinement over a deterministic CompiledNFA. Both algorithms take
+// an initial labelling of the states (states with different labels are never
+// merged) and return the coarsest stable refinement of it as a block index
+// per state. Blocks are numbered by their smallest state, so the result does
+// not depend on the algorithm used. Missing transitions are treated as going
+// to an implicit dead state that is distinct from every real state.
+class DFAMinimizer {
+public:
+  // Sequential.
+  static std::vector<int> Hopcroft(const CompiledNFA &dfa,
+                                   const std::vector<int> &initial_blocks);
+  static std::vector<int> Moore(const CompiledNFA &dfa,
+                                const std::vector<int> &initial_blocks);
+  // Moore rounds with the signatures hashed and grouped over state ranges
+  // on `pool`. Same result as Moore.
+  static std::vector<int> ParallelMoore(const CompiledNFA &dfa,
+                                        const std::vector<int> &initial_blocks,
+                                        WorkStealingPool &pool);
+
+  // Renumbers blocks in order of first occurrence and returns their count.
+  static int CanonicalizeBlocks(std::vector<int> &blocks);
+};
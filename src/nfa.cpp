@@ -1,5 +1,11 @@
 #include "nfa.hpp"
+#include "compiled-nfa.hpp"
+#include "minimizer.hpp"
+#include "regex-expr.hpp"
+#include "subset-interner.hpp"
+#include "thread-pool.hpp"
 #include <algorithm>
+#include <utility>
 
 // void PrintTokens(const std::vector<Token>& tokens) {
 //     for (const auto& token : tokens) {
@@ -26,7 +32,9 @@ std::unordered_map<int, int> NFAFactory::CopyStates(const NFA &from,
   std::unordered_map<int, int> state_id_map;
 
   for (const auto &state : from.states_) {
-    int new_id = into.CreateState(state->is_final)->id;
+    auto *new_state = into.CreateState(state->is_final);
+    new_state->pattern_ids = state->pattern_ids;
+    int new_id = new_state->id;
     state_id_map[state->id] = new_id;
 
     if (state->id == from.start_id_) {
@@ -132,84 +140,284 @@ NFA NFAFactory::KleeneStarNfa(const NFA &nfa) {
 }
 
 NFA NFAFactory::PostfixToNfa(const std::vector<Token> &postfix) {
-  std::stack<NFA> nfa_stack;
-
-  for (const auto &token : postfix) {
-    switch (GetTokenType(token)) {
-    case TokenType::Symbol: {
-      auto symbol_token = GetIf<SymbolToken>(token);
-      if (symbol_token) {
-        nfa_stack.push(CreateSymbolNfa(symbol_token->symbol));
+  return PostfixToNfa(InfixToPostfixConverter::Compact(postfix));
+}
+
+NFA NFAFactory::PostfixToNfa(std::string_view postfix) {
+  NFA result;
+  result.states_.reserve(2 * postfix.size());
+
+  Fragment fragment = AddPostfix(result, postfix);
+  result.start_id_ = fragment.start_id;
+  result.end_id_ = fragment.end_id;
+  return result;
+}
+
+NFA NFAFactory::PostfixToGlushkov(std::string_view postfix) {
+  // First and last positions of each subexpression; the follow relation is
+  // added as edges as soon as an operator creates it. An edge into a
+  // position is labelled with that position's symbol.
+  struct Positions {
+    std::vector<int> first;
+    std::vector<int> last;
+    bool nullable;
+  };
+
+  NFA result;
+  result.states_.reserve(postfix.size() + 1);
+  result.start_id_ = result.CreateState(false)->id;
+  std::vector<char> symbols{NFA::kEpsilon};
+
+  // Nested stars can add the same edge more than once; duplicates are
+  // dropped in one pass at the end.
+  auto add_follow = [&](const std::vector<int> &from,
+                        const std::vector<int> &to) {
+    for (int p : from) {
+      auto &transitions = result.GetState(p)->transitions;
+      char last_symbol = NFA::kEpsilon;
+      std::vector<int> *targets = nullptr;
+      for (int q : to) {
+        char symbol = symbols[q - result.start_id_];
+        if (targets == nullptr || symbol != last_symbol) {
+          targets = &transitions[symbol];
+          last_symbol = symbol;
+        }
+        targets->push_back(q);
       }
+    }
+  };
+
+  auto append = [](std::vector<int> &to, const std::vector<int> &from) {
+    to.insert(to.end(), from.begin(), from.end());
+  };
+
+  std::vector<Positions> stack;
+  for (char node : postfix) {
+    switch (node) {
+    case static_cast<char>(TokenType::One):
+      stack.push_back({{}, {}, true});
       break;
+    case static_cast<char>(TokenType::Concat):
+    case static_cast<char>(TokenType::Or): {
+      if (stack.size() < 2) {
+        throw std::runtime_error(node == '.'
+                                     ? "Insufficient operands for concatenation"
+                                     : "Insufficient operands for union");
+      }
+      Positions right = std::move(stack.back());
+      stack.pop_back();
+      Positions &left = stack.back();
+
+      if (node == '+') {
+        append(left.first, right.first);
+        append(left.last, right.last);
+        left.nullable = left.nullable || right.nullable;
+        break;
+      }
+
+      add_follow(left.last, right.first);
+      if (left.nullable) {
+        append(left.first, right.first);
+      }
+      if (right.nullable) {
+        append(right.last, left.last);
+      }
+      left.last = std::move(right.last);
+      left.nullable = left.nullable && right.nullable;
+      break;
+    }
+    case static_cast<char>(TokenType::KleeneStar):
+      if (stack.empty()) {
+        throw std::runtime_error("Insufficient operand for Kleene star");
+      }
+      add_follow(stack.back().last, stack.back().first);
+      stack.back().nullable = true;
+      break;
+    default: {
+      if (!std::isalpha(static_cast<unsigned char>(node))) {
+        throw std::runtime_error("Unexpected token in postfix expression");
+      }
+      int position = result.CreateState(false)->id;
+      symbols.push_back(node);
+      result.alphabet_.insert(node);
+      stack.push_back({{position}, {position}, false});
+      break;
+    }
+    }
+  }
+
+  if (stack.size() != 1) {
+    throw std::runtime_error("Invalid regex expression: stack has " +
+                             std::to_string(stack.size()) + " elements");
+  }
+
+  const Positions &whole = stack.back();
+  add_follow({result.start_id_}, whole.first);
+  for (int position : whole.last) {
+    result.GetState(position)->is_final = true;
+  }
+  result.GetState(result.start_id_)->is_final = whole.nullable;
+  // There are several accepting states in general and no single end state.
+  result.end_id_ = -1;
+
+  // seen[q] == p once p -> q has been kept.
+  std::vector<int> seen(result.states_.size(), -1);
+  for (const auto &state : result.states_) {
+    for (auto &[symbol, targets] : state->transitions) {
+      auto kept = targets.begin();
+      for (int q : targets) {
+        if (seen[q - result.start_id_] != state->id) {
+          seen[q - result.start_id_] = state->id;
+          *kept++ = q;
+        }
+      }
+      targets.erase(kept, targets.end());
+    }
+  }
+  return result;
+}
+
+NFA NFAFactory::PatternsToNfa(const std::vector<std::vector<Token>> &patterns) {
+  std::vector<std::string> compact;
+  compact.reserve(patterns.size());
+  for (const auto &postfix : patterns) {
+    compact.push_back(InfixToPostfixConverter::Compact(postfix));
+  }
+  return PatternsToNfa(compact);
+}
+
+NFA NFAFactory::PatternsToNfa(const std::vector<std::string> &patterns) {
+  NFA result;
+  size_t token_count = 0;
+  for (const auto &postfix : patterns) {
+    token_count += postfix.size();
+  }
+  result.states_.reserve(2 * token_count + 1);
+
+  result.start_id_ = result.CreateState(false)->id;
+  result.end_id_ = -1;
+
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    Fragment fragment = AddPostfix(result, patterns[i]);
+    result.AddTransition(result.start_id_, NFA::kEpsilon, fragment.start_id);
+    result.GetState(fragment.end_id)
+        ->pattern_ids.push_back(static_cast<int>(i));
+    if (result.end_id_ == -1) {
+      result.end_id_ = fragment.end_id;
     }
-    case TokenType::One: {
-      nfa_stack.push(CreateEpsilonNfa());
+  }
+
+  return result;
+}
+
+NFAFactory::Fragment NFAFactory::AddPostfix(NFA &result,
+                                            std::string_view postfix) {
+  // Fragments are spliced in place inside one automaton, so every operator
+  // adds a constant number of states and edges.
+  std::vector<Fragment> fragments;
+
+  for (char node : postfix) {
+    switch (node) {
+    case static_cast<char>(TokenType::One): {
+      fragments.push_back(AddBasicFragment(result, NFA::kEpsilon));
       break;
     }
-    case TokenType::Concat: {
-      if (nfa_stack.size() < 2) {
+    case static_cast<char>(TokenType::Concat): {
+      if (fragments.size() < 2) {
         throw std::runtime_error("Insufficient operands for concatenation");
       }
-      NFA right = std::move(nfa_stack.top());
-      nfa_stack.pop();
-      NFA left = std::move(nfa_stack.top());
-      nfa_stack.pop();
-      nfa_stack.push(ConcatNfas(left, right));
+      Fragment right = fragments.back();
+      fragments.pop_back();
+      Fragment &left = fragments.back();
+
+      result.AddTransition(left.end_id, NFA::kEpsilon, right.start_id);
+      result.UnmarkState(left.end_id);
+      left.end_id = right.end_id;
       break;
     }
-    case TokenType::Or: {
-      if (nfa_stack.size() < 2) {
+    case static_cast<char>(TokenType::Or): {
+      if (fragments.size() < 2) {
         throw std::runtime_error("Insufficient operands for union");
       }
-      NFA right = std::move(nfa_stack.top());
-      nfa_stack.pop();
-      NFA left = std::move(nfa_stack.top());
-      nfa_stack.pop();
-      nfa_stack.push(UnionNfas(left, right));
+      Fragment right = fragments.back();
+      fragments.pop_back();
+      Fragment left = fragments.back();
+      fragments.pop_back();
+
+      int new_start = result.CreateState(false)->id;
+      int new_end = result.CreateState(true)->id;
+
+      result.AddTransition(new_start, NFA::kEpsilon, left.start_id);
+      result.AddTransition(new_start, NFA::kEpsilon, right.start_id);
+      result.AddTransition(left.end_id, NFA::kEpsilon, new_end);
+      result.AddTransition(right.end_id, NFA::kEpsilon, new_end);
+
+      result.UnmarkState(left.end_id);
+      result.UnmarkState(right.end_id);
+      fragments.push_back({new_start, new_end});
       break;
     }
-    case TokenType::KleeneStar: {
-      if (nfa_stack.empty()) {
+    case static_cast<char>(TokenType::KleeneStar): {
+      if (fragments.empty()) {
         throw std::runtime_error("Insufficient operand for Kleene star");
       }
-      NFA nfa = std::move(nfa_stack.top());
-      nfa_stack.pop();
-      nfa_stack.push(KleeneStarNfa(nfa));
+      Fragment inner = fragments.back();
+      fragments.pop_back();
+
+      int new_start = result.CreateState(false)->id;
+      int new_end = result.CreateState(true)->id;
+
+      result.AddTransition(new_start, NFA::kEpsilon, inner.start_id);
+      result.AddTransition(new_start, NFA::kEpsilon, new_end);
+      result.AddTransition(inner.end_id, NFA::kEpsilon, inner.start_id);
+      result.AddTransition(inner.end_id, NFA::kEpsilon, new_end);
+
+      result.UnmarkState(inner.end_id);
+      fragments.push_back({new_start, new_end});
       break;
     }
     default:
-      throw std::runtime_error("Unexpected token in postfix expression");
+      if (!std::isalpha(static_cast<unsigned char>(node))) {
+        throw std::runtime_error("Unexpected token in postfix expression");
+      }
+      fragments.push_back(AddBasicFragment(result, node));
+      break;
     }
   }
 
-  if (nfa_stack.size() != 1) {
+  if (fragments.size() != 1) {
     throw std::runtime_error("Invalid regex expression: stack has " +
-                             std::to_string(nfa_stack.size()) + " elements");
+                             std::to_string(fragments.size()) + " elements");
   }
 
-  return std::move(nfa_stack.top());
+  return fragments.back();
+}
+
+NFAFactory::Fragment NFAFactory::AddBasicFragment(NFA &nfa, char symbol) {
+  int start_id = nfa.CreateState(false)->id;
+  int end_id = nfa.CreateState(true)->id;
+  nfa.AddTransition(start_id, symbol, end_id);
+  return {start_id, end_id};
 }
 
 NFA::NFAState::NFAState(int state_id, bool final)
     : id(state_id), is_final(final) {}
 
 NFA::NFAState *NFA::GetState(int id) {
-  for (auto &state : states_) {
-    if (state->id == id) {
-      return state.get();
-    }
-  }
-  return nullptr;
+  return const_cast<NFAState *>(std::as_const(*this).GetState(id));
 }
 
 const NFA::NFAState *NFA::GetState(int id) const {
-  for (auto &state : states_) {
-    if (state->id == id) {
-      return state.get();
-    }
+  if (states_.empty()) {
+    return nullptr;
   }
-  return nullptr;
+  // Ids are handed out consecutively by CreateState, so they are an offset
+  // into states_.
+  long index = static_cast<long>(id) - states_.front()->id;
+  if (index < 0 || index >= static_cast<long>(states_.size())) {
+    return nullptr;
+  }
+  return states_[index].get();
 }
 
 NFA::NFAState *NFA::CreateState(bool is_final) {
@@ -220,11 +428,9 @@ NFA::NFAState *NFA::CreateState(bool is_final) {
 }
 
 void NFA::UnmarkState(int id) {
-  for (auto &state : states_) {
-    if (state->id == id) {
-      state->is_final = false;
-      break;
-    }
+  NFAState *state = GetState(id);
+  if (state) {
+    state->is_final = false;
   }
 }
 
@@ -238,82 +444,30 @@ void NFA::AddTransition(int from_id, char symbol, int to_id) {
   }
 }
 
-std::set<int> NFA::EpsilonClosure(const std::set<int> &states) const {
-  std::set<int> closure = states;
-  std::queue<int> to_process;
-
-  for (int state_id : states) {
-    to_process.push(state_id);
-  }
-
-  while (!to_process.empty()) {
-    int current_id = to_process.front();
-    to_process.pop();
-
-    const NFAState *current_state = GetState(current_id);
-    if (!current_state) {
-      continue;
-    }
-
-    auto epsilon_trans = current_state->transitions.find(kEpsilon);
-    if (epsilon_trans != current_state->transitions.end()) {
-      for (int next_id : epsilon_trans->second) {
-        if (closure.find(next_id) == closure.end()) {
-          closure.insert(next_id);
-          to_process.push(next_id);
-        }
-      }
-    }
-  }
-
-  return closure;
-}
-
-std::set<int> NFA::FindReachableInOneStep(const std::set<int> &states,
-                                          char symbol) const {
-  std::set<int> result;
-
-  for (int state_id : states) {
-    const NFAState *state = GetState(state_id);
-    if (!state) {
-      continue;
-    }
+NFA::NFA(int start_size) : size_(start_size) {}
 
-    auto transitions = state->transitions.find(symbol);
-    if (transitions != state->transitions.end()) {
-      for (int next_id : transitions->second) {
-        result.insert(next_id);
-      }
-    }
+NFA::NFA(const std::string &regex, bool is_postfix) {
+  if (!is_postfix) {
+    *this = NFAFactory::PostfixToNfa(
+        InfixToPostfixConverter::ParseCompact(regex));
+    return;
   }
 
-  return result;
-}
-
-bool NFA::ContainsFinalState(const std::set<int> &states) const {
-  for (int state_id : states) {
-    const NFAState *state = GetState(state_id);
-    if (state && state->is_final) {
-      return true;
+  std::string postfix;
+  postfix.reserve(regex.size());
+  for (char c : regex) {
+    if (!std::isspace(static_cast<unsigned char>(c))) {
+      postfix.push_back(c);
     }
   }
-  return false;
+  *this = NFAFactory::PostfixToNfa(postfix);
 }
 
-NFA::NFA(int start_size) : size_(start_size) {}
-
-NFA::NFA(const std::string &regex, bool is_postfix) {
-  Lexer lexer;
-  lexer.Tokenize(regex);
-
-  if (!is_postfix) {
-    lexer.AddConcatenationOperators();
-    InfixToPostfixConverter converter;
-    auto postfix = converter.Convert(lexer.GetTokens());
-    *this = NFAFactory::PostfixToNfa(postfix);
-  } else {
-    *this = NFAFactory::PostfixToNfa(lexer.GetTokens());
-  }
+NFA::NFA(const std::string &regex, NFAConstruction construction) {
+  std::string postfix = InfixToPostfixConverter::ParseCompact(regex);
+  *this = construction == NFAConstruction::Glushkov
+              ? NFAFactory::PostfixToGlushkov(postfix)
+              : NFAFactory::PostfixToNfa(postfix);
 }
 
 NFA::NFA(NFA &&other) noexcept
@@ -330,6 +484,7 @@ NFA::NFA(const NFA &other)
   for (const auto &state : other.states_) {
     auto new_state = std::make_unique<NFAState>(state->id, state->is_final);
     new_state->transitions = state->transitions;
+    new_state->pattern_ids = state->pattern_ids;
     states_.push_back(std::move(new_state));
   }
 }
@@ -360,6 +515,7 @@ NFA &NFA::operator=(const NFA &other) {
     for (const auto &state : other.states_) {
       auto new_state = std::make_unique<NFAState>(state->id, state->is_final);
       new_state->transitions = state->transitions;
+      new_state->pattern_ids = state->pattern_ids;
       states_.push_back(std::move(new_state));
     }
   }
@@ -399,15 +555,16 @@ void NFA::Print() const {
   }
 }
 
-NFA NFA::GetDFA() const {
+NFA NFA::GetDFA(unsigned threads) const {
   NFA result(*this);
-  result.ToDFA();
+  result.ToDFA(threads);
   return result;
 }
 
-NFA NFA::GetMinimal() const {
+NFA NFA::GetMinimal(MinimizationAlgorithm algorithm,
+                    unsigned threads) const {
   NFA result(*this);
-  result.ToMinimal();
+  result.ToMinimal(algorithm, threads);
   return result;
 }
 
@@ -423,53 +580,136 @@ NFA NFA::GetComplement() const {
   return result;
 }
 
-void NFA::ToDFA() {
-  std::set<char> alphabet = GetAlphabet();
-  alphabet.erase(kEpsilon);
+namespace {
+
+// Null when `threads` asks for the sequential path, which needs no workers.
+std::unique_ptr<WorkStealingPool> MakePool(unsigned threads) {
+  if (threads == 1) {
+    return nullptr;
+  }
+  return std::make_unique<WorkStealingPool>(threads);
+}
+
+} // namespace
+
+void NFA::ToDFA(unsigned threads) { Determinize(MakePool(threads).get()); }
+
+void NFA::ToDFA(WorkStealingPool &pool) { Determinize(&pool); }
 
-  std::map<std::set<int>, int> state_mapping;
-  std::queue<std::set<int>> unprocessed_states;
+void NFA::Determinize(WorkStealingPool *pool) {
+  CompiledNFA nfa(*this);
+  const std::vector<char> &alphabet = nfa.GetAlphabet();
 
   NFA dfa;
 
-  std::set<int> start_closure = EpsilonClosure({start_id_});
-  if (start_closure.empty()) {
+  if (nfa.GetStart() < 0) {
     int start_state_id = dfa.CreateState(false)->id;
     dfa.start_id_ = start_state_id;
     *this = std::move(dfa);
     return;
   }
 
-  state_mapping[start_closure] = 0;
-  int start_state_id = dfa.CreateState()->id;
-  dfa.GetState(start_state_id)->is_final = ContainsFinalState(start_closure);
-  dfa.start_id_ = start_state_id;
-  unprocessed_states.push(start_closure);
-
-  while (!unprocessed_states.empty()) {
-    std::set<int> current_set = unprocessed_states.front();
-    unprocessed_states.pop();
+  auto add_state = [&](const std::vector<int> &set) {
+    auto *state = dfa.CreateState(nfa.ContainsFinalState(set));
+    if (nfa.HasPatternIds()) {
+      nfa.CollectPatternIds(set, state->pattern_ids);
+    }
+    return state->id;
+  };
+
+  // DFA state i is subset i of the interner; subsets are interned in BFS
+  // order, so walking the ids in order is the work queue.
+  SubsetInterner subsets;
+  std::vector<int> next_set(nfa.ClosureBegin(nfa.GetStart()),
+                            nfa.ClosureEnd(nfa.GetStart()));
+  subsets.Intern(next_set);
+  dfa.start_id_ = add_state(next_set);
+
+  // In parallel mode the states of one BFS level are expanded concurrently
+  // against the read-only interner. New subsets are then interned in the
+  // same (state, symbol) order as the sequential loop, so ids match it.
+  struct Successor {
+    int id;
+    std::vector<int> set;
+  };
+  constexpr int kNoSuccessor = -2;
+  constexpr int kMinParallelLevel = 64;
+
+  std::vector<std::vector<Successor>> level_successors;
+  CompiledNFA::StepScratch scratch;
+
+  int level_begin = 0;
+  while (level_begin < subsets.Size()) {
+    int level_end = subsets.Size();
+
+    if (!pool || pool->ThreadCount() == 1 ||
+        level_end - level_begin < kMinParallelLevel) {
+      for (int current = level_begin; current < level_end; ++current) {
+        for (char symbol : alphabet) {
+          nfa.FindReachableInOneStep(subsets.Begin(current),
+                                     subsets.End(current), symbol, next_set,
+                                     scratch);
 
-    int current_dfa_state_id = state_mapping[current_set];
+          if (next_set.empty()) {
+            continue;
+          }
 
-    for (char symbol : alphabet) {
-      std::set<int> next_set =
-          EpsilonClosure(FindReachableInOneStep(current_set, symbol));
+          auto [next, inserted] = subsets.Intern(next_set);
+          if (inserted) {
+            add_state(next_set);
+          }
 
-      if (next_set.empty()) {
-        continue;
+          dfa.AddTransition(current, symbol, next);
+        }
       }
+      level_begin = level_end;
+      continue;
+    }
 
-      if (state_mapping.find(next_set) == state_mapping.end()) {
-        int new_state_id = dfa.CreateState()->id;
-        dfa.GetState(new_state_id)->is_final = ContainsFinalState(next_set);
-        state_mapping[next_set] = new_state_id;
-        unprocessed_states.push(next_set);
+    level_successors.resize(level_end - level_begin);
+    pool->ParallelFor(level_end - level_begin, [&](size_t i) {
+      int current = level_begin + static_cast<int>(i);
+      auto &successors = level_successors[i];
+      successors.assign(alphabet.size(), {kNoSuccessor, {}});
+
+      std::vector<int> set;
+      thread_local CompiledNFA::StepScratch worker_scratch;
+      for (size_t k = 0; k < alphabet.size(); ++k) {
+        nfa.FindReachableInOneStep(subsets.Begin(current), subsets.End(current),
+                                   alphabet[k], set, worker_scratch);
+        if (set.empty()) {
+          continue;
+        }
+
+        successors[k].id = subsets.Find(set);
+        if (successors[k].id == -1) {
+          successors[k].set = std::move(set);
+          set.clear();
+        }
       }
+    });
 
-      int next_dfa_state_id = state_mapping[next_set];
-      dfa.AddTransition(current_dfa_state_id, symbol, next_dfa_state_id);
+    for (int current = level_begin; current < level_end; ++current) {
+      auto &successors = level_successors[current - level_begin];
+      for (size_t k = 0; k < alphabet.size(); ++k) {
+        int next = successors[k].id;
+        if (next == kNoSuccessor) {
+          continue;
+        }
+
+        if (next == -1) {
+          auto interned = subsets.Intern(successors[k].set);
+          next = interned.first;
+          if (interned.second) {
+            add_state(successors[k].set);
+          }
+        }
+
+        dfa.AddTransition(current, alphabet[k], next);
+      }
+      successors.clear();
     }
+    level_begin = level_end;
   }
 
   dfa.end_id_ = -1;
@@ -487,132 +727,75 @@ void NFA::ToDFA() {
   *this = std::move(dfa);
 }
 
-void NFA::ToMinimal() {
-  ToDFA();
+void NFA::ToMinimal(MinimizationAlgorithm algorithm, unsigned threads) {
+  // One pool serves both the subset construction and the refinement.
+  Minimize(algorithm, MakePool(threads).get());
+}
+
+void NFA::ToMinimal(MinimizationAlgorithm algorithm, WorkStealingPool &pool) {
+  Minimize(algorithm, &pool);
+}
+
+void NFA::Minimize(MinimizationAlgorithm algorithm, WorkStealingPool *pool) {
+  Determinize(pool);
 
   if (states_.size() <= 1) {
     return;
   }
 
-  std::set<char> alphabet = GetAlphabet();
-  alphabet.erase(kEpsilon);
-
-  std::vector<std::set<int>> partitions;
-
-  std::set<int> final_states;
-  std::set<int> non_final_states;
+  CompiledNFA dfa(*this);
+  const std::vector<char> &alphabet = dfa.GetAlphabet();
 
-  for (const auto &state : states_) {
-    if (state->is_final) {
-      final_states.insert(state->id);
-    } else {
-      non_final_states.insert(state->id);
+  // States start out split by what they accept: finality, and for pattern
+  // sets the exact set of accepted pattern ids.
+  std::vector<int> initial_blocks(dfa.StateCount());
+  if (dfa.HasPatternIds()) {
+    std::map<std::pair<bool, std::vector<int>>, int> label_of;
+    for (int state = 0; state < dfa.StateCount(); ++state) {
+      std::pair<bool, std::vector<int>> key(
+          dfa.IsFinal(state),
+          std::vector<int>(dfa.PatternIdsBegin(state),
+                           dfa.PatternIdsEnd(state)));
+      initial_blocks[state] =
+          label_of.emplace(std::move(key), static_cast<int>(label_of.size()))
+              .first->second;
     }
-  }
-
-  if (!final_states.empty()) {
-    partitions.push_back(final_states);
-  }
-  if (!non_final_states.empty()) {
-    partitions.push_back(non_final_states);
-  }
-
-  bool changed = true;
-  while (changed) {
-    changed = false;
-    std::vector<std::set<int>> new_partitions;
-
-    for (const auto &partition : partitions) {
-      if (partition.size() <= 1) {
-        new_partitions.push_back(partition);
-        continue;
-      }
-
-      std::map<std::vector<int>, std::set<int>> behavior_groups;
-
-      for (int state_id : partition) {
-        const NFAState *current_state = GetState(state_id);
-        if (!current_state) {
-          continue;
-        }
-
-        std::vector<int> signature;
-        for (char symbol : alphabet) {
-          int target_partition = -1;
-          auto trans = current_state->transitions.find(symbol);
-          if (trans != current_state->transitions.end() &&
-              !trans->second.empty()) {
-            int target_id = trans->second[0];
-            for (size_t i = 0; i < partitions.size(); ++i) {
-              if (partitions[i].find(target_id) != partitions[i].end()) {
-                target_partition = static_cast<int>(i);
-                break;
-              }
-            }
-          }
-          signature.push_back(target_partition);
-        }
-
-        behavior_groups[signature].insert(state_id);
-      }
-
-      for (const auto &group : behavior_groups) {
-        new_partitions.push_back(group.second);
-      }
-
-      if (behavior_groups.size() > 1) {
-        changed = true;
-      }
+  } else {
+    for (int state = 0; state < dfa.StateCount(); ++state) {
+      initial_blocks[state] = dfa.IsFinal(state) ? 1 : 0;
     }
+  }
 
-    if (partitions.size() != new_partitions.size()) {
-      changed = true;
+  std::vector<int> blocks;
+  if (algorithm == MinimizationAlgorithm::Hopcroft) {
+    blocks = DFAMinimizer::Hopcroft(dfa, initial_blocks);
+  } else {
+    if (pool && pool->ThreadCount() > 1) {
+      blocks = DFAMinimizer::ParallelMoore(dfa, initial_blocks, *pool);
+    } else {
+      blocks = DFAMinimizer::Moore(dfa, initial_blocks);
     }
-    partitions = new_partitions;
   }
 
   NFA minimized_dfa;
-  std::map<int, int> partition_representative;
-  std::map<int, int> new_state_ids;
+  std::vector<int> representatives;
 
-  for (const auto &partition : partitions) {
-    int representative_id = *partition.begin();
-
-    bool is_final = false;
-    for (int state_id : partition) {
-      const NFAState *state = GetState(state_id);
-      if (state && state->is_final) {
-        is_final = true;
-        break;
-      }
-    }
-
-    int new_state_id = minimized_dfa.CreateState(is_final)->id;
-    new_state_ids[representative_id] = new_state_id;
-
-    for (int state_id : partition) {
-      partition_representative[state_id] = representative_id;
-    }
-
-    if (partition.find(start_id_) != partition.end()) {
-      minimized_dfa.start_id_ = new_state_id;
+  for (int state = 0; state < dfa.StateCount(); ++state) {
+    if (blocks[state] == static_cast<int>(representatives.size())) {
+      representatives.push_back(state);
+      minimized_dfa.CreateState(dfa.IsFinal(state))
+          ->pattern_ids.assign(dfa.PatternIdsBegin(state),
+                               dfa.PatternIdsEnd(state));
     }
   }
+  minimized_dfa.start_id_ = blocks[dfa.GetStart()];
 
-  for (const auto &partition : partitions) {
-    int representative_id = *partition.begin();
-    int new_state_id = new_state_ids[representative_id];
-
-    const NFAState *rep_state = GetState(representative_id);
-    if (rep_state) {
-      for (char symbol : alphabet) {
-        auto trans = rep_state->transitions.find(symbol);
-        if (trans != rep_state->transitions.end() && !trans->second.empty()) {
-          int target_old_id = trans->second[0];
-          int target_rep_id = partition_representative[target_old_id];
-          int target_new_id = new_state_ids[target_rep_id];
-          minimized_dfa.AddTransition(new_state_id, symbol, target_new_id);
-        }
+  for (size_t block = 0; block < representatives.size(); ++block) {
+    for (char symbol : alphabet) {
+      int target = dfa.FindTarget(representatives[block], symbol);
+      if (target != -1) {
+        minimized_dfa.AddTransition(static_cast<int>(block), symbol,
+                                    blocks[target]);
       }
     }
   }
@@ -676,6 +859,7 @@ void NFA::ToComplement() {
 
   for (auto &state : states_) {
     state->is_final = !state->is_final;
+    state->pattern_ids.clear();
   }
 
   end_id_ = -1;
@@ -691,287 +875,111 @@ bool RegexFactory::IsEmptyRegex(const std::string &r) { return r == "epsilon"; }
 
 bool RegexFactory::IsEpsilonRegex(const std::string &r) { return r == "1"; }
 
-std::string RegexFactory::WrapIfNeeded(const std::string &r) {
-  if (r.empty())
-    return "1";
-  if (r == "1" || r == "epsilon")
-    return r;
-  if (r.size() == 1 && std::isalnum((unsigned char)r[0]))
-    return r;
-  if (r.front() == '(' && r.back() == ')') {
-    int bal = 0;
-    for (size_t i = 0; i < r.size(); ++i) {
-      if (r[i] == '(')
-        ++bal;
-      else if (r[i] == ')')
-        --bal;
-      if (bal == 0 && i + 1 < r.size()) {
-        return "(" + r + ")";
-      }
-    }
-    return r;
-  }
-  return "(" + r + ")";
-}
-
-std::string RegexFactory::UnionRegex(const std::string &a,
-                                     const std::string &b) {
-  if (a == b)
-    return a;
-  if (IsEmptyRegex(a) && IsEmptyRegex(b))
-    return std::string("epsilon");
-  if (IsEmptyRegex(a))
-    return b;
-  if (IsEmptyRegex(b))
-    return a;
-  if (IsEpsilonRegex(a) && IsEpsilonRegex(b))
-    return std::string("1");
-  if (IsEpsilonRegex(a)) {
-    if (b == "epsilon")
-      return "1";
-    return "(" + std::string("1") + "+" + b + ")";
-  }
-  if (IsEpsilonRegex(b)) {
-    if (a == "epsilon")
-      return "1";
-    return "(" + a + "+" + std::string("1") + ")";
-  }
-  return "(" + a + "+" + b + ")";
-}
-
-std::string RegexFactory::ConcatRegex(const std::string &a,
-                                      const std::string &b) {
-  if (IsEmptyRegex(a) || IsEmptyRegex(b))
-    return std::string("epsilon");
-  if (IsEpsilonRegex(a))
-    return b;
-  if (IsEpsilonRegex(b))
-    return a;
-  return WrapIfNeeded(a) + WrapIfNeeded(b);
-}
-
-std::string RegexFactory::StarRegex(const std::string &r) {
-  if (IsEmptyRegex(r))
-    return std::string("1");
-  if (IsEpsilonRegex(r))
-    return std::string("1");
-  if (!r.empty() && r.back() == '*')
-    return r;
-  if (r.size() == 1 && std::isalnum((unsigned char)r[0]))
-    return r + "*";
-  return WrapIfNeeded(r) + "*";
-}
-
-std::string RegexFactory::StripOuterParensOnce(const std::string &s) {
-  if (s.size() >= 2 && s.front() == '(' && s.back() == ')') {
-    int bal = 0;
-    for (size_t i = 0; i < s.size(); ++i) {
-      if (s[i] == '(')
-        ++bal;
-      else if (s[i] == ')')
-        --bal;
-      if (bal == 0 && i + 1 < s.size())
-        return s;
-    }
-    return s.substr(1, s.size() - 2);
-  }
-  return s;
-}
-
 std::string RegexFactory::SimplifyRegex(const std::string &inp) {
-  std::string cur = inp;
-  for (int pass = 0; pass < 6; ++pass) {
-    std::string prev = cur;
-
-    if (cur == "(epsilon)")
-      cur = "epsilon";
-    if (cur == "(1)")
-      cur = "1";
-    cur = StripOuterParensOnce(cur);
-
-    {
-      std::string out;
-      for (size_t i = 0; i < cur.size();) {
-        if (cur.compare(i, 2, "1*") == 0) {
-          out += "1";
-          i += 2;
-          continue;
-        }
-        if (cur.compare(i, 8, "epsilon*") == 0) {
-          out += "1";
-          i += 8;
-          continue;
-        }
-        if (cur.compare(i, 4, "(1)*") == 0) {
-          out += "1";
-          i += 4;
-          continue;
-        }
-        if (cur.compare(i, 10, "(epsilon)*") == 0) {
-          out += "1";
-          i += 10;
-          continue;
-        }
-        out.push_back(cur[i++]);
-      }
-      cur.swap(out);
-    }
-
-    {
-      std::string out;
-      for (size_t i = 0; i < cur.size();) {
-        if (cur.compare(i, 2, "1(") == 0) {
-          i += 1;
-          continue;
-        }
-        if (cur.compare(i, 1, "1") == 0) {
-          if (i + 1 < cur.size() &&
-              (std::isalnum((unsigned char)cur[i + 1]) || cur[i + 1] == '(')) {
-            ++i;
-            continue;
-          }
-        }
-        if (i + 1 < cur.size() && cur[i + 1] == '1') {
-          if (std::isalnum((unsigned char)cur[i]) || cur[i] == ')') {
-            out.push_back(cur[i]);
-            i += 2;
-            continue;
-          }
-        }
-        out.push_back(cur[i++]);
-      }
-      cur.swap(out);
-    }
-
-    if (cur == prev)
-      break;
-  }
-  if (cur == "(1)")
-    cur = "1";
-  if (cur == "(epsilon)")
-    cur = "epsilon";
-  return cur;
+  if (inp.empty())
+    return inp;
+  RegexExprPool pool;
+  return pool.ToString(pool.Parse(inp));
 }
 
 std::string NFA::ToRegex() const {
   if (states_.empty())
     return "epsilon";
 
-  std::vector<int> ids;
-  ids.reserve(states_.size());
+  // State elimination on a sparse graph whose edges are labelled with
+  // hash-consed expressions. Node n is the new start and n + 1 the new
+  // accept state.
+  int n = static_cast<int>(states_.size());
+  int new_start = n;
+  int new_accept = n + 1;
+
+  auto start =
+      std::find_if(states_.begin(), states_.end(),
+                   [this](const auto &s) { return s->id == start_id_; });
+  if (start == states_.end())
+    return "epsilon";
+
   std::unordered_map<int, int> id_to_index;
-  for (const auto &s : states_) {
-    id_to_index[s->id] = static_cast<int>(ids.size());
-    ids.push_back(s->id);
+  for (int i = 0; i < n; ++i) {
+    id_to_index[states_[i]->id] = i;
   }
-  int n = static_cast<int>(ids.size());
-  if (n == 0)
-    return "epsilon";
 
-  std::vector<std::vector<std::string>> R(
-      n, std::vector<std::string>(n, "epsilon"));
+  RegexExprPool pool;
+  std::vector<std::map<int, RegexExprPool::ExprId>> out(n + 2);
+  std::vector<std::map<int, RegexExprPool::ExprId>> in(n + 2);
+
+  auto add_edge = [&](int from, int to, RegexExprPool::ExprId label) {
+    auto [it, inserted] = out[from].emplace(to, label);
+    if (!inserted) {
+      it->second = pool.Union(it->second, label);
+    }
+    in[to][from] = it->second;
+  };
 
-  for (const auto &s : states_) {
-    int i = id_to_index.at(s->id);
-    for (const auto &tr : s->transitions) {
-      char sym = tr.first;
-      std::string label =
-          (sym == kEpsilon ? std::string("1") : std::string(1, sym));
+  for (int i = 0; i < n; ++i) {
+    for (const auto &tr : states_[i]->transitions) {
+      RegexExprPool::ExprId label =
+          tr.first == kEpsilon ? RegexExprPool::kOne : pool.Symbol(tr.first);
       for (int to_id : tr.second) {
         auto it = id_to_index.find(to_id);
-        if (it == id_to_index.end())
-          continue;
-        int j = it->second;
-        R[i][j] = RegexFactory::UnionRegex(R[i][j], label);
+        if (it != id_to_index.end()) {
+          add_edge(i, it->second, label);
+        }
       }
     }
-  }
-
-  int newStart = n;
-  int newAccept = n + 1;
-  int N = n + 2;
-  std::vector<std::vector<std::string>> G(
-      N, std::vector<std::string>(N, "epsilon"));
-
-  for (int i = 0; i < n; ++i)
-    for (int j = 0; j < n; ++j)
-      G[i][j] = R[i][j];
-
-  auto itStart = id_to_index.find(start_id_);
-  if (itStart == id_to_index.end())
-    return "epsilon";
-  G[newStart][itStart->second] =
-      RegexFactory::UnionRegex(G[newStart][itStart->second], std::string("1"));
-
-  for (const auto &s : states_) {
-    if (s->is_final) {
-      int i = id_to_index.at(s->id);
-      G[i][newAccept] =
-          RegexFactory::UnionRegex(G[i][newAccept], std::string("1"));
+    if (states_[i]->is_final) {
+      add_edge(i, new_accept, RegexExprPool::kOne);
     }
   }
+  add_edge(new_start, static_cast<int>(start - states_.begin()),
+           RegexExprPool::kOne);
 
-  for (int k = 0; k < N; ++k) {
-    if (k == newStart || k == newAccept)
-      continue;
+  // Eliminating a state creates up to in x out new edges, so the state with
+  // the fewest is removed first.
+  std::vector<char> eliminated(n, 0);
+  for (int step = 0; step < n; ++step) {
+    int k = -1;
+    size_t best_cost = 0;
+    for (int i = 0; i < n; ++i) {
+      if (eliminated[i]) {
+        continue;
+      }
+      size_t cost = in[i].size() * out[i].size();
+      if (k == -1 || cost < best_cost) {
+        k = i;
+        best_cost = cost;
+      }
+    }
+    eliminated[k] = 1;
 
-    std::string Rkk = G[k][k];
+    auto self_loop = out[k].find(k);
+    RegexExprPool::ExprId loop = pool.Star(
+        self_loop == out[k].end() ? RegexExprPool::kEmpty : self_loop->second);
 
-    for (int i = 0; i < N; ++i) {
-      if (i == k)
-        continue;
-      if (RegexFactory::IsEmptyRegex(G[i][k]))
+    for (const auto &[i, into_k] : in[k]) {
+      if (i == k) {
         continue;
-      for (int j = 0; j < N; ++j) {
-        if (j == k)
-          continue;
-        if (RegexFactory::IsEmptyRegex(G[k][j]))
+      }
+      out[i].erase(k);
+      for (const auto &[j, from_k] : out[k]) {
+        if (j == k) {
           continue;
-
-        std::string via = RegexFactory::ConcatRegex(
-            G[i][k],
-            RegexFactory::ConcatRegex(RegexFactory::StarRegex(Rkk), G[k][j]));
-        G[i][j] = RegexFactory::UnionRegex(G[i][j], via);
+        }
+        add_edge(i, j, pool.Concat(into_k, pool.Concat(loop, from_k)));
       }
     }
-
-    for (int i = 0; i < N; ++i)
-      G[i][k] = "epsilon";
-    for (int j = 0; j < N; ++j)
-      G[k][j] = "epsilon";
+    for (const auto &[j, from_k] : out[k]) {
+      in[j].erase(k);
+    }
+    out[k].clear();
+    in[k].clear();
   }
 
-  std::string result = G[newStart][newAccept];
-  if (result.empty())
-    result = "epsilon";
-
-  result = RegexFactory::SimplifyRegex(result);
-
-  return result;
+  auto result = out[new_start].find(new_accept);
+  return pool.ToString(result == out[new_start].end() ? RegexExprPool::kEmpty
+                                                      : result->second);
 }
 
-int NFA::ContainsPrefix(const std::string &str) const {
-  std::set<int> current = EpsilonClosure({start_id_});
-  int longest_match = -1;
-
-  if (ContainsFinalState(current)) {
-    longest_match = 0;
-  }
-
-  for (size_t i = 0; i < str.length(); i++) {
-    char c = str[i];
-    std::set<int> next = EpsilonClosure(FindReachableInOneStep(current, c));
-
-    if (next.empty()) {
-      break;
-    }
-
-    current = next;
-
-    if (ContainsFinalState(current)) {
-      longest_match = i + 1;
-    }
-  }
-
-  return longest_match;
+int64_t NFA::ContainsPrefix(const std::string &str) const {
+  return CompiledNFA(*this).ContainsPrefix(str);
 }
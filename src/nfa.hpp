@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -8,20 +9,35 @@
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "lexer.hpp"
 #include "postfix-to-suffix.hpp"
 
+enum class MinimizationAlgorithm { Hopcroft, Moore };
+
+// Thompson adds two states and up to four epsilon edges per operator.
+// Glushkov builds the position automaton: a start state plus one state per
+// symbol occurrence, with no epsilon edges and no single end state.
+enum class NFAConstruction { Thompson, Glushkov };
+
+class WorkStealingPool;
+
 class NFA {
   friend class NFAFactory;
   friend class NFAManualTest;
+  friend class CompiledNFA;
+  friend class DerivativeDFA;
 
   struct NFAState {
     int id;
     bool is_final;
     std::unordered_map<char, std::vector<int>> transitions;
+    // Sorted ids of the patterns accepted in this state. Only automata built
+    // by NFAFactory::PatternsToNfa (and their DFAs) set them.
+    std::vector<int> pattern_ids;
 
     explicit NFAState(int state_id, bool final = false);
   };
@@ -39,19 +55,19 @@ class NFA {
   const NFAState *GetState(int id) const;
 
   void UnmarkState(int id);
-  bool ContainsFinalState(const std::set<int> &states) const;
 
   NFAState *CreateState(bool is_final = false);
   void AddTransition(int from_id, char symbol, int to_id);
 
-  std::set<int> EpsilonClosure(const std::set<int> &states) const;
-  std::set<int> FindReachableInOneStep(const std::set<int> &states,
-                                       char symbol) const;
+  // A null pool runs sequentially.
+  void Determinize(WorkStealingPool *pool);
+  void Minimize(MinimizationAlgorithm algorithm, WorkStealingPool *pool);
 
 public:
   NFA() = default;
   explicit NFA(int start_size);
   explicit NFA(const std::string &regex, bool is_postfix = false);
+  NFA(const std::string &regex, NFAConstruction construction);
 
   NFA(NFA &&other) noexcept;
   NFA &operator=(NFA &&other) noexcept;
@@ -76,25 +92,60 @@ public:
   std::set<char> GetAlphabet() const { return alphabet_; }
 
   void Print() const;
-  void ToDFA();
-  void ToMinimal();
+  // `threads` > 1 expands each BFS level of the subset construction on a
+  // work-stealing pool (0 uses every core); the result is identical. The
+  // overloads taking a pool run on the caller's threads instead of starting
+  // new ones for every call. The pool may be shared: conversions on several
+  // threads take turns on it, one parallel loop at a time.
+  void ToDFA(unsigned threads = 1);
+  void ToDFA(WorkStealingPool &pool);
+  // Only the Moore refinement runs on several threads; Hopcroft is
+  // sequential, so with the default algorithm `threads` only speeds up the
+  // subset construction. Moore needs one round per level of a deep DFA,
+  // where Hopcroft is the better choice. bench/minimizer-bench.cpp times
+  // both. A shared pool is used as by ToDFA.
+  void ToMinimal(
+      MinimizationAlgorithm algorithm = MinimizationAlgorithm::Hopcroft,
+      unsigned threads = 1);
+  void ToMinimal(MinimizationAlgorithm algorithm, WorkStealingPool &pool);
   void ToComplete();
   void ToComplement();
 
-  NFA GetDFA() const;
-  NFA GetMinimal() const;
+  NFA GetDFA(unsigned threads = 1) const;
+  NFA GetMinimal(
+      MinimizationAlgorithm algorithm = MinimizationAlgorithm::Hopcroft,
+      unsigned threads = 1) const;
   NFA GetComplete() const;
   NFA GetComplement() const;
 
-  int ContainsPrefix(const std::string &str) const;
+  // Length of the longest accepted prefix of `str`, or -1. Compiles the
+  // automaton on every call; hold a CompiledNFA to match many inputs.
+  int64_t ContainsPrefix(const std::string &str) const;
   std::string ToRegex() const;
 };
 
 class NFAFactory {
+  struct Fragment {
+    int start_id;
+    int end_id;
+  };
+
   static std::unordered_map<int, int> CopyStates(const NFA &from, NFA &into);
+  static Fragment AddBasicFragment(NFA &nfa, char symbol);
+  // `postfix` is in the compact form of InfixToPostfixConverter.
+  static Fragment AddPostfix(NFA &nfa, std::string_view postfix);
 
 public:
   static NFA PostfixToNfa(const std::vector<Token> &postfix);
+  static NFA PostfixToNfa(std::string_view postfix);
+  // Position automaton of a compact postfix regex. It may have several
+  // accepting states, so GetEnd() is null and the result cannot be passed
+  // to ConcatNfas, UnionNfas or KleeneStarNfa.
+  static NFA PostfixToGlushkov(std::string_view postfix);
+  // Union of all patterns under one new start state. The final state of
+  // pattern i carries pattern id i.
+  static NFA PatternsToNfa(const std::vector<std::vector<Token>> &patterns);
+  static NFA PatternsToNfa(const std::vector<std::string> &patterns);
   static NFA CreateSymbolNfa(char symbol);
   static NFA CreateEpsilonNfa();
   static NFA ConcatNfas(const NFA &first, const NFA &second);
@@ -106,10 +157,6 @@ class RegexFactory {
 public:
   static bool IsEmptyRegex(const std::string &r);
   static bool IsEpsilonRegex(const std::string &r);
-  static std::string WrapIfNeeded(const std::string &r);
-  static std::string UnionRegex(const std::string &a, const std::string &b);
-  static std::string ConcatRegex(const std::string &a, const std::string &b);
-  static std::string StarRegex(const std::string &r);
-  static std::string StripOuterParensOnce(const std::string &s);
+  // Rewrites the regex through RegexExprPool in a single bottom-up pass.
   static std::string SimplifyRegex(const std::string &inp);
 };
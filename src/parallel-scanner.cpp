@@ -0,0 +1,136 @@
+#include "parallel-scanner.hpp"
+
+#include <algorithm>
+#include <thread>
+
+ParallelScanner::ParallelScanner(const DenseDFA &dfa, unsigned threads,
+                                 size_t min_chunk_size)
+    : dfa_(&dfa), threads_(threads), min_chunk_size_(min_chunk_size) {
+  if (threads_ == 0) {
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+  min_chunk_size_ = std::max<size_t>(min_chunk_size_, 1);
+}
+
+void ParallelScanner::ScanChunk(std::string_view chunk,
+                                const std::vector<int> &entries,
+                                ChunkSummary &summary) const {
+  const int n = dfa_->StateCount();
+  summary.end_state.assign(n, DenseDFA::kDeadState);
+  summary.last_accept.assign(n, -1);
+
+  // Every entry follows a run; runs in the same state are merged every
+  // kMergeInterval bytes. Accepts seen by a run are credited to its entries
+  // when it is merged.
+  std::vector<int> run_of(entries.size());
+  std::vector<int> run_state(entries);
+  std::vector<int64_t> run_accept(entries.size(), -1);
+  std::vector<int> next_run_state;
+  std::vector<int> run_in_state(n, -1);
+  for (size_t e = 0; e < entries.size(); ++e) {
+    run_of[e] = static_cast<int>(e);
+  }
+
+  auto merge_runs = [&] {
+    next_run_state.clear();
+    for (size_t e = 0; e < entries.size(); ++e) {
+      int run = run_of[e];
+      if (run == -1) {
+        continue;
+      }
+
+      int entry = entries[e];
+      summary.last_accept[entry] =
+          std::max(summary.last_accept[entry], run_accept[run]);
+
+      int state = run_state[run];
+      if (state == DenseDFA::kDeadState) {
+        run_of[e] = -1;
+        continue;
+      }
+      if (run_in_state[state] == -1) {
+        run_in_state[state] = static_cast<int>(next_run_state.size());
+        next_run_state.push_back(state);
+      }
+      run_of[e] = run_in_state[state];
+    }
+
+    for (int state : next_run_state) {
+      run_in_state[state] = -1;
+    }
+    run_state.swap(next_run_state);
+    run_accept.assign(run_state.size(), -1);
+  };
+
+  for (size_t block = 0; block < chunk.size() && !run_state.empty();
+       block += kMergeInterval) {
+    size_t block_end = std::min(chunk.size(), block + kMergeInterval);
+
+    for (size_t run = 0; run < run_state.size(); ++run) {
+      int state = run_state[run];
+      for (size_t i = block; i < block_end; ++i) {
+        state = dfa_->Next(state, static_cast<unsigned char>(chunk[i]));
+        if (state == DenseDFA::kDeadState) {
+          break;
+        }
+        if (dfa_->IsFinal(state)) {
+          run_accept[run] = static_cast<int64_t>(i + 1);
+        }
+      }
+      run_state[run] = state;
+    }
+
+    merge_runs();
+  }
+
+  for (size_t e = 0; e < entries.size(); ++e) {
+    if (run_of[e] != -1) {
+      summary.end_state[entries[e]] = run_state[run_of[e]];
+    }
+  }
+}
+
+int64_t ParallelScanner::ContainsPrefix(std::string_view str) const {
+  size_t chunk_count = std::min<size_t>(threads_, str.size() / min_chunk_size_);
+  if (chunk_count <= 1) {
+    return dfa_->ContainsPrefix(str);
+  }
+
+  std::vector<size_t> bounds(chunk_count + 1);
+  for (size_t c = 0; c <= chunk_count; ++c) {
+    bounds[c] = str.size() / chunk_count * c +
+                str.size() % chunk_count * c / chunk_count;
+  }
+
+  std::vector<int> all_states;
+  for (int state = 1; state < dfa_->StateCount(); ++state) {
+    all_states.push_back(state);
+  }
+
+  std::vector<ChunkSummary> summaries(chunk_count);
+  auto chunk = [&](size_t c) {
+    return str.substr(bounds[c], bounds[c + 1] - bounds[c]);
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t c = 1; c < chunk_count; ++c) {
+    workers.emplace_back(
+        [&, c] { ScanChunk(chunk(c), all_states, summaries[c]); });
+  }
+  ScanChunk(chunk(0), {dfa_->GetStart()}, summaries[0]);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  int state = dfa_->GetStart();
+  int64_t longest_match = dfa_->IsFinal(state) ? 0 : -1;
+  for (size_t c = 0; c < chunk_count && state != DenseDFA::kDeadState; ++c) {
+    int64_t last_accept = summaries[c].last_accept[state];
+    if (last_accept != -1) {
+      longest_match = static_cast<int64_t>(bounds[c]) + last_accept;
+    }
+    state = summaries[c].end_state[state];
+  }
+
+  return longest_match;
+}
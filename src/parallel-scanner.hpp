@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "dense-dfa.hpp"
+
+// Data-parallel ContainsPrefix over a DenseDFA. The input is cut into one
+// chunk per thread. The first chunk is scanned from the start state; every
+// other chunk is scanned from all states at once, recording for each entry
+// state where the chunk ends and the last accepting position inside it.
+// The per-chunk functions are then composed in order, which gives exactly
+// the sequential result. Runs that reach the same state are merged as they
+// go, so small DFAs cost little more than a single scan per chunk.
+class ParallelScanner {
+  struct ChunkSummary {
+    // Indexed by entry state.
+    std::vector<int> end_state;
+    // Last accepting offset relative to the chunk start, or -1.
+    std::vector<int64_t> last_accept;
+  };
+
+  // Bytes scanned between two merges of converged runs.
+  static constexpr size_t kMergeInterval = 64;
+
+  const DenseDFA *dfa_;
+  unsigned threads_;
+  size_t min_chunk_size_;
+
+  void ScanChunk(std::string_view chunk, const std::vector<int> &entries,
+                 ChunkSummary &summary) const;
+
+public:
+  static constexpr size_t kDefaultMinChunkSize = size_t{1} << 16;
+
+  // `threads` == 0 uses the hardware concurrency. Inputs are never cut into
+  // chunks shorter than `min_chunk_size`. The DFA must outlive the scanner.
+  explicit ParallelScanner(const DenseDFA &dfa, unsigned threads = 0,
+                           size_t min_chunk_size = kDefaultMinChunkSize);
+
+  // Same result as DenseDFA::ContainsPrefix.
+  int64_t ContainsPrefix(std::string_view str) const;
+};
@@ -0,0 +1,74 @@
+#include "pattern-cache.hpp"
+
+PatternCache::PatternCache(size_t capacity) : capacity_(capacity) {}
+
+PatternCache &PatternCache::Global() {
+  static PatternCache cache;
+  return cache;
+}
+
+std::string PatternCache::NormalizeRegex(const std::string &regex) {
+  return InfixToPostfixConverter::ParseCompact(regex);
+}
+
+std::shared_ptr<const NFA> PatternCache::Get(const std::string &regex) {
+  std::string key = NormalizeRegex(regex);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      ++hits_;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->automaton;
+    }
+    ++misses_;
+  }
+
+  // The position automaton has no epsilon edges, so determinizing it is
+  // cheaper; the minimal DFA is the same.
+  auto automaton =
+      std::make_shared<NFA>(NFAFactory::PostfixToGlushkov(key));
+  automaton->ToMinimal();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->automaton;
+  }
+  if (capacity_ == 0) {
+    return automaton;
+  }
+
+  entries_.push_front({key, std::move(automaton)});
+  index_[key] = entries_.begin();
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  return entries_.front().automaton;
+}
+
+size_t PatternCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t PatternCache::Hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t PatternCache::Misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void PatternCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
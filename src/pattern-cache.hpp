@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "nfa.hpp"
+
+// Thread-safe LRU cache of minimized automata. Patterns are keyed by their
+// postfix token stream, so spelling differences such as whitespace,
+// implicit concatenation or redundant parentheses share one entry. Cached
+// automata are immutable and stay valid after eviction for as long as a
+// caller holds them.
+class PatternCache {
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const NFA> automaton;
+  };
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+
+public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  explicit PatternCache(size_t capacity = kDefaultCapacity);
+
+  // Cache shared by the whole process.
+  static PatternCache &Global();
+
+  // Postfix form of `regex`, one character per token.
+  static std::string NormalizeRegex(const std::string &regex);
+
+  // Returns the minimal DFA of `regex`, compiling it on a miss. Compilation
+  // runs outside the lock; if two threads miss on the same pattern, the
+  // first result inserted wins.
+  std::shared_ptr<const NFA> Get(const std::string &regex);
+
+  size_t Size() const;
+  size_t Capacity() const { return capacity_; }
+  size_t Hits() const;
+  size_t Misses() const;
+  void Clear();
+};
@@ -1,5 +1,7 @@
 #include "postfix-to-suffix.hpp"
 
+#include <cctype>
+
 std::vector<Token>
 InfixToPostfixConverter::Convert(const std::vector<Token> &tokens) {
   std::vector<Token> postfix;
@@ -54,3 +56,83 @@ int InfixToPostfixConverter::Precedence(TokenType op) {
     return 0;
   }
 }
+
+std::string InfixToPostfixConverter::ParseCompact(std::string_view regex) {
+  std::string postfix;
+  // Every byte yields at most one node plus one implicit concatenation.
+  postfix.reserve(2 * regex.size());
+  std::string op_stack;
+
+  auto push_operator = [&](char op, int precedence) {
+    while (!op_stack.empty() && op_stack.back() != '(' &&
+           (op_stack.back() == '.' ? 2 : 1) >= precedence) {
+      postfix.push_back(op_stack.back());
+      op_stack.pop_back();
+    }
+    op_stack.push_back(op);
+  };
+
+  // Whether the previous token ends an operand, as in
+  // Lexer::DoesNeedConcat.
+  bool after_operand = false;
+
+  for (char c : regex) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      continue;
+    }
+
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '1') {
+      if (after_operand) {
+        push_operator('.', 2);
+      }
+      postfix.push_back(c);
+      after_operand = true;
+    } else if (c == '(') {
+      if (after_operand) {
+        push_operator('.', 2);
+      }
+      op_stack.push_back('(');
+      after_operand = false;
+    } else if (c == ')') {
+      while (!op_stack.empty() && op_stack.back() != '(') {
+        postfix.push_back(op_stack.back());
+        op_stack.pop_back();
+      }
+      if (op_stack.empty()) {
+        throw std::runtime_error("Mismatched parentheses");
+      }
+      op_stack.pop_back();
+      after_operand = true;
+    } else if (c == '*') {
+      // Nothing binds tighter, so the star applies right away.
+      postfix.push_back('*');
+      after_operand = true;
+    } else if (c == '.' || c == '+') {
+      push_operator(c, c == '.' ? 2 : 1);
+      after_operand = false;
+    } else {
+      throw std::runtime_error(std::string("Unexpected character: ") + c);
+    }
+  }
+
+  while (!op_stack.empty()) {
+    if (op_stack.back() == '(') {
+      throw std::runtime_error("Mismatched parentheses");
+    }
+    postfix.push_back(op_stack.back());
+    op_stack.pop_back();
+  }
+  return postfix;
+}
+
+std::string
+InfixToPostfixConverter::Compact(const std::vector<Token> &postfix) {
+  std::string compact;
+  compact.reserve(postfix.size());
+  for (const auto &token : postfix) {
+    auto symbol_token = GetIf<SymbolToken>(token);
+    compact.push_back(symbol_token ? symbol_token->symbol
+                                   : static_cast<char>(GetTokenType(token)));
+  }
+  return compact;
+}
@@ -3,6 +3,7 @@
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "lexer.hpp"
@@ -11,6 +12,15 @@ class InfixToPostfixConverter {
 public:
   std::vector<Token> Convert(const std::vector<Token> &tokens);
 
+  // Compact postfix: one byte per node, the symbol itself for symbols and
+  // the TokenType character ('1', '.', '+', '*') for everything else.
+  //
+  // Lexes, inserts implicit concatenation and converts in a single pass
+  // over `regex`, with the same result and errors as Tokenize,
+  // AddConcatenationOperators and Convert in turn.
+  static std::string ParseCompact(std::string_view regex);
+  static std::string Compact(const std::vector<Token> &postfix);
+
 private:
   int Precedence(TokenType op);
 };
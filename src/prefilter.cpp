@@ -0,0 +1,306 @@
+#include "prefilter.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stack>
+#include <stdexcept>
+
+#include "postfix-to-suffix.hpp"
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+LiteralAnalyzer::Info LiteralAnalyzer::Exact(std::string literal) {
+  if (literal.size() <= kMaxLiteral) {
+    return {true, literal, literal, literal};
+  }
+
+  std::string prefix = literal.substr(0, kMaxLiteral);
+  std::string suffix = literal.substr(literal.size() - kMaxLiteral);
+  return {false, prefix, suffix, prefix};
+}
+
+const std::string &LiteralAnalyzer::Longest(const std::string &a,
+                                            const std::string &b) {
+  return b.size() > a.size() ? b : a;
+}
+
+LiteralAnalyzer::Info LiteralAnalyzer::Concat(const Info &left,
+                                              const Info &right) {
+  if (left.is_exact && right.is_exact) {
+    return Exact(left.prefix + right.prefix);
+  }
+
+  Info result{false, left.prefix, right.suffix, ""};
+  if (left.is_exact) {
+    result.prefix = (left.prefix + right.prefix).substr(0, kMaxLiteral);
+  }
+  if (right.is_exact) {
+    std::string suffix = left.suffix + right.suffix;
+    result.suffix = suffix.substr(suffix.size() > kMaxLiteral
+                                      ? suffix.size() - kMaxLiteral
+                                      : 0);
+  }
+
+  std::string joint = (left.suffix + right.prefix).substr(0, kMaxLiteral);
+  result.inner = Longest(Longest(left.inner, right.inner), joint);
+  return result;
+}
+
+LiteralAnalyzer::Info LiteralAnalyzer::Union(const Info &left,
+                                             const Info &right) {
+  if (left.is_exact && right.is_exact && left.prefix == right.prefix) {
+    return left;
+  }
+
+  Info result{false, "", "", ""};
+
+  size_t common = 0;
+  while (common < left.prefix.size() && common < right.prefix.size() &&
+         left.prefix[common] == right.prefix[common]) {
+    ++common;
+  }
+  result.prefix = left.prefix.substr(0, common);
+
+  common = 0;
+  while (common < left.suffix.size() && common < right.suffix.size() &&
+         left.suffix[left.suffix.size() - 1 - common] ==
+             right.suffix[right.suffix.size() - 1 - common]) {
+    ++common;
+  }
+  result.suffix = left.suffix.substr(left.suffix.size() - common);
+
+  // Any common substring of the literals required by both sides is required
+  // by the union.
+  result.inner = Longest(Longest(result.prefix, result.suffix),
+                         LongestCommonSubstring(left.inner, right.inner));
+  return result;
+}
+
+std::string LiteralAnalyzer::LongestCommonSubstring(const std::string &a,
+                                                    const std::string &b) {
+  std::vector<size_t> previous(b.size() + 1, 0);
+  std::vector<size_t> current(b.size() + 1, 0);
+  size_t best_length = 0;
+  size_t best_end = 0;
+
+  for (size_t i = 1; i <= a.size(); ++i) {
+    for (size_t j = 1; j <= b.size(); ++j) {
+      current[j] = a[i - 1] == b[j - 1] ? previous[j - 1] + 1 : 0;
+      if (current[j] > best_length) {
+        best_length = current[j];
+        best_end = i;
+      }
+    }
+    std::swap(previous, current);
+  }
+
+  return a.substr(best_end - best_length, best_length);
+}
+
+RequiredLiterals LiteralAnalyzer::AnalyzePostfix(std::string_view postfix) {
+  std::stack<Info> info_stack;
+
+  for (char node : postfix) {
+    switch (node) {
+    case static_cast<char>(TokenType::One):
+      info_stack.push(Exact(""));
+      break;
+    case static_cast<char>(TokenType::Concat):
+    case static_cast<char>(TokenType::Or): {
+      if (info_stack.size() < 2) {
+        throw std::runtime_error("Insufficient operands for binary operator");
+      }
+      Info right = std::move(info_stack.top());
+      info_stack.pop();
+      Info left = std::move(info_stack.top());
+      info_stack.pop();
+      info_stack.push(node == static_cast<char>(TokenType::Concat)
+                          ? Concat(left, right)
+                          : Union(left, right));
+      break;
+    }
+    case static_cast<char>(TokenType::KleeneStar):
+      if (info_stack.empty()) {
+        throw std::runtime_error("Insufficient operand for Kleene star");
+      }
+      info_stack.top() = {false, "", "", ""};
+      break;
+    default:
+      if (!std::isalpha(static_cast<unsigned char>(node))) {
+        throw std::runtime_error("Unexpected token in postfix expression");
+      }
+      info_stack.push(Exact(std::string(1, node)));
+      break;
+    }
+  }
+
+  if (info_stack.size() != 1) {
+    throw std::runtime_error("Invalid regex expression");
+  }
+
+  const Info &info = info_stack.top();
+  return {info.prefix, Longest(info.inner, info.prefix)};
+}
+
+RequiredLiterals LiteralAnalyzer::Analyze(const std::vector<Token> &postfix) {
+  return AnalyzePostfix(InfixToPostfixConverter::Compact(postfix));
+}
+
+RequiredLiterals LiteralAnalyzer::Analyze(const std::string &regex) {
+  return AnalyzePostfix(InfixToPostfixConverter::ParseCompact(regex));
+}
+
+size_t FindByte(const char *data, size_t size, char byte) {
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i needle = _mm256_set1_epi8(byte);
+  for (; i + 32 <= size; i += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    uint32_t mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i needle = _mm_set1_epi8(byte);
+  for (; i + 16 <= size; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    uint32_t mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  if (i < size) {
+    const void *found = std::memchr(data + i, byte, size - i);
+    if (found != nullptr) {
+      return static_cast<const char *>(found) - data;
+    }
+  }
+  return size;
+}
+
+size_t FindLiteral(const char *data, size_t size, std::string_view literal) {
+  size_t n = literal.size();
+  if (n == 0) {
+    return 0;
+  }
+  if (n > size) {
+    return size;
+  }
+  if (n == 1) {
+    return FindByte(data, size, literal[0]);
+  }
+
+  // Candidates must match both the first and the last byte of the literal;
+  // only those are compared in full.
+  size_t last_start = size - n;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i first = _mm256_set1_epi8(literal[0]);
+  const __m256i last = _mm256_set1_epi8(literal[n - 1]);
+  for (; i + 32 <= last_start + 1; i += 32) {
+    __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(data + i + n - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                         _mm256_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      size_t candidate = i + __builtin_ctz(mask);
+      if (std::memcmp(data + candidate + 1, literal.data() + 1, n - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i first = _mm_set1_epi8(literal[0]);
+  const __m128i last = _mm_set1_epi8(literal[n - 1]);
+  for (; i + 16 <= last_start + 1; i += 16) {
+    __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + n - 1));
+    uint32_t mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                        _mm_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      size_t candidate = i + __builtin_ctz(mask);
+      if (std::memcmp(data + candidate + 1, literal.data() + 1, n - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  while (i <= last_start) {
+    const void *found = std::memchr(data + i, literal[0], last_start + 1 - i);
+    if (found == nullptr) {
+      break;
+    }
+    i = static_cast<const char *>(found) - data;
+    if (std::memcmp(data + i + 1, literal.data() + 1, n - 1) == 0) {
+      return i;
+    }
+    ++i;
+  }
+  return size;
+}
+
+size_t FindAnyByte(const char *data, size_t size, std::string_view bytes) {
+  if (bytes.size() == 1) {
+    return FindByte(data, size, bytes[0]);
+  }
+  if (bytes.empty()) {
+    return size;
+  }
+
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  for (; i + 32 <= size; i += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    __m256i hits = _mm256_setzero_si256();
+    for (char byte : bytes) {
+      hits = _mm256_or_si256(
+          hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(byte)));
+    }
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    __m128i hits = _mm_setzero_si128();
+    for (char byte : bytes) {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(byte)));
+    }
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; i < size; ++i) {
+    if (bytes.find(data[i]) != std::string_view::npos) {
+      return i;
+    }
+  }
+  return size;
+}
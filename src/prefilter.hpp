@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer.hpp"
+
+// Literals that every match of a regex must contain.
+struct RequiredLiterals {
+  // Every match starts with `prefix`.
+  std::string prefix;
+  // Every match contains `inner` somewhere; the longest one found.
+  std::string inner;
+};
+
+class LiteralAnalyzer {
+  // Literals longer than this are cut, which keeps them required but bounds
+  // the analysis to linear time.
+  static constexpr size_t kMaxLiteral = 64;
+
+  struct Info {
+    bool is_exact;
+    std::string prefix;
+    std::string suffix;
+    std::string inner;
+  };
+
+  static Info Exact(std::string literal);
+  static Info Concat(const Info &left, const Info &right);
+  static Info Union(const Info &left, const Info &right);
+  static const std::string &Longest(const std::string &a,
+                                    const std::string &b);
+  static std::string LongestCommonSubstring(const std::string &a,
+                                            const std::string &b);
+  // `postfix` is in the compact form of InfixToPostfixConverter.
+  static RequiredLiterals AnalyzePostfix(std::string_view postfix);
+
+public:
+  static RequiredLiterals Analyze(const std::vector<Token> &postfix);
+  static RequiredLiterals Analyze(const std::string &regex);
+};
+
+// memchr/memmem-style scans using SSE2 or AVX2 when the target supports
+// them, with a scalar fallback. Both return `size` when nothing is found.
+size_t FindByte(const char *data, size_t size, char byte);
+size_t FindLiteral(const char *data, size_t size, std::string_view literal);
+// First byte of `data` that is one of `bytes`. Every block is compared
+// against each of them, so this is meant for small sets.
+size_t FindAnyByte(const char *data, size_t size, std::string_view bytes);
@@ -0,0 +1,61 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "codegen.hpp"
+#include "nfa.hpp"
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: regex-codegen [--table] [--namespace NAME] REGEX "
+               "OUTPUT\n"
+               "Writes a C++ header with longest_prefix() and match() for\n"
+               "the minimal DFA of REGEX. The default is direct-coded "
+               "states;\n"
+               "--table emits a table-driven matcher instead.\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  CodeGenerator::Options options;
+  int arg = 1;
+  for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; ++arg) {
+    if (std::strcmp(argv[arg], "--table") == 0) {
+      options.style = CodeGenerator::Style::Table;
+    } else if (std::strcmp(argv[arg], "--namespace") == 0 && arg + 1 < argc) {
+      options.namespace_name = argv[++arg];
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  if (argc - arg != 2) {
+    PrintUsage();
+    return 2;
+  }
+
+  try {
+    options.source_regex = argv[arg];
+    std::string path = argv[arg + 1];
+
+    NFA nfa(options.source_regex);
+    nfa.ToMinimal();
+    std::string source = CodeGenerator::Generate(nfa, options);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << source;
+    if (!out) {
+      std::cerr << "Error: cannot write " << path << std::endl;
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,377 @@
+#include "regex-expr.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+RegexExprPool::RegexExprPool() {
+  Intern(Kind::Empty, 0, 0);
+  Intern(Kind::One, 0, 0);
+}
+
+RegexExprPool::ExprId RegexExprPool::Intern(Kind kind, int left, int right) {
+  Node node{kind, left, right};
+  auto it = ids_.emplace(node, static_cast<ExprId>(nodes_.size()));
+  if (it.second) {
+    nodes_.push_back(node);
+    switch (kind) {
+    case Kind::Empty:
+    case Kind::Symbol:
+      nullable_.push_back(false);
+      break;
+    case Kind::One:
+    case Kind::Star:
+      nullable_.push_back(true);
+      break;
+    case Kind::Union:
+      nullable_.push_back(nullable_[left] || nullable_[right]);
+      break;
+    case Kind::Concat:
+      nullable_.push_back(nullable_[left] && nullable_[right]);
+      break;
+    }
+  }
+  return it.first->second;
+}
+
+RegexExprPool::ExprId RegexExprPool::Symbol(char symbol) {
+  return Intern(Kind::Symbol, static_cast<unsigned char>(symbol), 0);
+}
+
+std::vector<RegexExprPool::ExprId> RegexExprPool::Factors(ExprId id) const {
+  std::vector<ExprId> factors;
+  std::vector<ExprId> pending{id};
+  while (!pending.empty()) {
+    ExprId current = pending.back();
+    pending.pop_back();
+    if (GetKind(current) == Kind::Concat) {
+      pending.push_back(Right(current));
+      pending.push_back(Left(current));
+    } else {
+      factors.push_back(current);
+    }
+  }
+  return factors;
+}
+
+RegexExprPool::ExprId RegexExprPool::FromFactors(const ExprId *begin,
+                                                 const ExprId *end) {
+  if (begin == end) {
+    return kOne;
+  }
+  ExprId result = *--end;
+  while (end != begin) {
+    result = Intern(Kind::Concat, *--end, result);
+  }
+  return result;
+}
+
+std::vector<RegexExprPool::ExprId>
+RegexExprPool::Alternatives(ExprId id) const {
+  std::vector<ExprId> alternatives;
+  std::vector<ExprId> pending{id};
+  while (!pending.empty()) {
+    ExprId current = pending.back();
+    pending.pop_back();
+    if (GetKind(current) == Kind::Union) {
+      pending.push_back(Right(current));
+      pending.push_back(Left(current));
+    } else {
+      alternatives.push_back(current);
+    }
+  }
+  return alternatives;
+}
+
+const std::unordered_set<RegexExprPool::ExprId> &
+RegexExprPool::AlternativeSet(ExprId id) {
+  if (id != cached_union_) {
+    std::vector<ExprId> alternatives = Alternatives(id);
+    cached_alternatives_.clear();
+    cached_alternatives_.insert(alternatives.begin(), alternatives.end());
+    cached_union_ = id;
+  }
+  return cached_alternatives_;
+}
+
+RegexExprPool::ExprId RegexExprPool::NewUnion(ExprId a, ExprId b) {
+  ExprId result = Intern(Kind::Union, a, b);
+  if (cached_union_ == a || cached_union_ == b) {
+    for (ExprId alternative : Alternatives(cached_union_ == a ? b : a)) {
+      cached_alternatives_.insert(alternative);
+    }
+    cached_union_ = result;
+  }
+  return result;
+}
+
+RegexExprPool::ExprId RegexExprPool::Union(ExprId a, ExprId b) {
+  if (a == b || b == kEmpty) {
+    return a;
+  }
+  if (a == kEmpty) {
+    return b;
+  }
+
+  // x + y = x when every alternative of y is already one of x. The set comes
+  // from the cached side when there is one, so only the alternatives of the
+  // other side are walked.
+  if (GetKind(a) == Kind::Union || GetKind(b) == Kind::Union) {
+    bool from_right = cached_union_ == b || GetKind(a) != Kind::Union;
+    ExprId large = from_right ? b : a;
+    ExprId small = from_right ? a : b;
+    const std::unordered_set<ExprId> &large_set = AlternativeSet(large);
+    std::vector<ExprId> alternatives = Alternatives(small);
+    if (std::all_of(alternatives.begin(), alternatives.end(),
+                    [&](ExprId id) { return large_set.count(id) != 0; })) {
+      return large;
+    }
+    // The other direction needs at least as many alternatives.
+    if (large_set.size() <= alternatives.size()) {
+      std::unordered_set<ExprId> small_set(alternatives.begin(),
+                                           alternatives.end());
+      if (std::all_of(large_set.begin(), large_set.end(),
+                      [&](ExprId id) { return small_set.count(id) != 0; })) {
+        return small;
+      }
+    }
+  }
+
+  if (a == kOne || b == kOne) {
+    ExprId other = a == kOne ? b : a;
+    // 1 + x* = x*, 1 + xx* = x* and 1 + x*x = x*
+    if (GetKind(other) == Kind::Star) {
+      return other;
+    }
+    if (GetKind(other) == Kind::Concat) {
+      std::vector<ExprId> factors = Factors(other);
+      auto is_body = [this](const ExprId *begin, const ExprId *end,
+                            ExprId star) {
+        std::vector<ExprId> body = Factors(Left(star));
+        return std::equal(begin, end, body.begin(), body.end());
+      };
+      const ExprId *begin = factors.data();
+      const ExprId *end = begin + factors.size();
+      if (GetKind(end[-1]) == Kind::Star && is_body(begin, end - 1, end[-1])) {
+        return end[-1];
+      }
+      if (GetKind(*begin) == Kind::Star && is_body(begin + 1, end, *begin)) {
+        return *begin;
+      }
+    }
+    return NewUnion(a, b);
+  }
+
+  // xay + xby = x(a + b)y. Without this, eliminating a state with several
+  // successors copies the path into it once per successor and the printed
+  // expression grows exponentially.
+  if (GetKind(a) == Kind::Concat || GetKind(b) == Kind::Concat) {
+    std::vector<ExprId> left = Factors(a);
+    std::vector<ExprId> right = Factors(b);
+    size_t limit = std::min(left.size(), right.size());
+    size_t prefix = 0;
+    while (prefix < limit && left[prefix] == right[prefix]) {
+      ++prefix;
+    }
+    size_t suffix = 0;
+    while (prefix + suffix < limit &&
+           left[left.size() - 1 - suffix] == right[right.size() - 1 - suffix]) {
+      ++suffix;
+    }
+    if (prefix + suffix > 0) {
+      const ExprId *l = left.data();
+      const ExprId *r = right.data();
+      ExprId middle =
+          Union(FromFactors(l + prefix, l + left.size() - suffix),
+                FromFactors(r + prefix, r + right.size() - suffix));
+      return Concat(FromFactors(l, l + prefix),
+                    Concat(middle, FromFactors(l + left.size() - suffix,
+                                               l + left.size())));
+    }
+  }
+
+  return NewUnion(a, b);
+}
+
+RegexExprPool::ExprId RegexExprPool::Concat(ExprId a, ExprId b) {
+  if (a == kEmpty || b == kEmpty) {
+    return kEmpty;
+  }
+  if (a == kOne) {
+    return b;
+  }
+  if (b == kOne) {
+    return a;
+  }
+  return Intern(Kind::Concat, a, b);
+}
+
+RegexExprPool::ExprId RegexExprPool::Star(ExprId a) {
+  if (a == kEmpty || a == kOne) {
+    return kOne;
+  }
+  if (GetKind(a) == Kind::Star) {
+    return a;
+  }
+  return Intern(Kind::Star, a, 0);
+}
+
+RegexExprPool::ExprId RegexExprPool::Parse(std::string_view regex) {
+  // Shunting-yard as in InfixToPostfixConverter, except that operands are
+  // reduced to nodes right away instead of being written out in postfix.
+  std::vector<ExprId> operands;
+  std::vector<char> operators;
+  // Whether the previous token ends an operand, so that a following operand
+  // is concatenated to it.
+  bool after_operand = false;
+
+  auto precedence = [](char op) { return op == '+' ? 0 : op == '.' ? 1 : -1; };
+
+  auto reduce = [&]() {
+    char op = operators.back();
+    operators.pop_back();
+    if (operands.size() < 2) {
+      throw std::runtime_error("Insufficient operands for binary operator");
+    }
+    ExprId right = operands.back();
+    operands.pop_back();
+    ExprId left = operands.back();
+    operands.back() = op == '+' ? Union(left, right) : Concat(left, right);
+  };
+
+  auto push_operator = [&](char op) {
+    while (!operators.empty() &&
+           precedence(operators.back()) >= precedence(op)) {
+      reduce();
+    }
+    operators.push_back(op);
+    after_operand = false;
+  };
+
+  auto push_operand = [&](ExprId operand) {
+    if (after_operand) {
+      push_operator('.');
+    }
+    operands.push_back(operand);
+    after_operand = true;
+  };
+
+  for (size_t i = 0; i < regex.size(); ++i) {
+    char c = regex[i];
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      continue;
+    }
+
+    if (regex.compare(i, 7, "epsilon") == 0) {
+      push_operand(kEmpty);
+      i += 6;
+    } else if (std::isalpha(static_cast<unsigned char>(c))) {
+      push_operand(Symbol(c));
+    } else if (c == '1') {
+      push_operand(kOne);
+    } else if (c == '(') {
+      if (after_operand) {
+        push_operator('.');
+      }
+      operators.push_back('(');
+    } else if (c == ')') {
+      while (!operators.empty() && operators.back() != '(') {
+        reduce();
+      }
+      if (operators.empty()) {
+        throw std::runtime_error("Mismatched parentheses");
+      }
+      operators.pop_back();
+      after_operand = true;
+    } else if (c == '*') {
+      if (!after_operand) {
+        throw std::runtime_error("Insufficient operand for Kleene star");
+      }
+      operands.back() = Star(operands.back());
+    } else if (c == '+' || c == '.') {
+      push_operator(c);
+    } else {
+      throw std::runtime_error(std::string("Unexpected character: ") + c);
+    }
+  }
+
+  while (!operators.empty()) {
+    if (operators.back() == '(') {
+      throw std::runtime_error("Mismatched parentheses");
+    }
+    reduce();
+  }
+  if (operands.size() != 1) {
+    throw std::runtime_error("Invalid regex expression");
+  }
+  return operands.back();
+}
+
+std::string RegexExprPool::ToString(ExprId id) const {
+  // Operators bind as star > concat > union. Subterms are written with an
+  // explicit stack since shared DAGs can unfold into very deep trees.
+  auto precedence = [this](ExprId expr) {
+    switch (GetKind(expr)) {
+    case Kind::Union:
+      return 0;
+    case Kind::Concat:
+      return 1;
+    default:
+      return 2;
+    }
+  };
+
+  std::string out;
+  // Either a node to print in a context of the given precedence, or (when
+  // `text` is set) a literal piece of output.
+  struct Item {
+    ExprId expr;
+    int context;
+    const char *text;
+  };
+  std::vector<Item> stack{{id, 0, nullptr}};
+
+  while (!stack.empty()) {
+    Item item = stack.back();
+    stack.pop_back();
+    if (item.text != nullptr) {
+      out += item.text;
+      continue;
+    }
+
+    ExprId expr = item.expr;
+    bool parenthesize = precedence(expr) < item.context;
+    if (parenthesize) {
+      out += '(';
+      stack.push_back({0, 0, ")"});
+    }
+
+    switch (GetKind(expr)) {
+    case Kind::Empty:
+      out += "epsilon";
+      break;
+    case Kind::One:
+      out += '1';
+      break;
+    case Kind::Symbol:
+      out += GetSymbol(expr);
+      break;
+    case Kind::Union:
+      stack.push_back({Right(expr), 0, nullptr});
+      stack.push_back({0, 0, "+"});
+      stack.push_back({Left(expr), 0, nullptr});
+      break;
+    case Kind::Concat:
+      stack.push_back({Right(expr), 1, nullptr});
+      stack.push_back({Left(expr), 1, nullptr});
+      break;
+    case Kind::Star:
+      stack.push_back({0, 0, "*"});
+      stack.push_back({Left(expr), 2, nullptr});
+      break;
+    }
+  }
+
+  return out;
+}
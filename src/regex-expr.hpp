@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Hash-consed DAG of regular expressions. Every distinct node is stored once
+// and referred to by an id, so equal subterms are shared and compared in
+// O(1). The constructors apply the algebraic identities that keep terms
+// small (the empty language and the empty word as units and zeros, x + x =
+// x, (x*)* = x*, 1 + xx* = x*, common prefixes and suffixes of a union
+// factored out), and strings are only produced by ToString.
+class RegexExprPool {
+public:
+  using ExprId = int;
+
+  enum class Kind : uint8_t { Empty, One, Symbol, Union, Concat, Star };
+
+  // The empty language, printed as "epsilon" like RegexFactory does.
+  static constexpr ExprId kEmpty = 0;
+  // The empty word, printed as "1".
+  static constexpr ExprId kOne = 1;
+
+private:
+  struct Node {
+    Kind kind;
+    // Symbol: the character in `left`. Union, Concat: both operands.
+    // Star: the operand in `left`.
+    int left;
+    int right;
+
+    bool operator==(const Node &other) const {
+      return kind == other.kind && left == other.left && right == other.right;
+    }
+  };
+
+  struct NodeHash {
+    size_t operator()(const Node &node) const {
+      uint64_t hash = static_cast<uint64_t>(node.kind);
+      hash = hash * 0x9e3779b97f4a7c15ull + static_cast<uint32_t>(node.left);
+      hash = hash * 0x9e3779b97f4a7c15ull + static_cast<uint32_t>(node.right);
+      return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+  };
+
+  std::vector<Node> nodes_;
+  // Whether each node matches the empty word, computed once when interned.
+  std::vector<char> nullable_;
+  std::unordered_map<Node, ExprId, NodeHash> ids_;
+  // Distinct alternatives of the union built last. Unions are mostly grown
+  // one alternative at a time, so the absorption check in Union extends this
+  // set instead of collecting the whole union again.
+  ExprId cached_union_ = kEmpty;
+  std::unordered_set<ExprId> cached_alternatives_;
+
+  ExprId Intern(Kind kind, int left, int right);
+  const std::unordered_set<ExprId> &AlternativeSet(ExprId id);
+  // Interns a + b and moves the cached alternatives along with it.
+  ExprId NewUnion(ExprId a, ExprId b);
+  // Right-nested concatenation of factors that are not concatenations.
+  ExprId FromFactors(const ExprId *begin, const ExprId *end);
+
+public:
+  RegexExprPool();
+
+  ExprId Symbol(char symbol);
+  ExprId Union(ExprId a, ExprId b);
+  ExprId Concat(ExprId a, ExprId b);
+  ExprId Star(ExprId a);
+
+  // Reads the Lexer syntax plus "epsilon" for the empty language, which is
+  // what ToString writes. Every node goes through the constructors above,
+  // so the result is already simplified. Throws std::runtime_error for
+  // malformed input.
+  ExprId Parse(std::string_view regex);
+
+  Kind GetKind(ExprId id) const { return nodes_[id].kind; }
+
+  char GetSymbol(ExprId id) const { return static_cast<char>(nodes_[id].left); }
+
+  ExprId Left(ExprId id) const { return nodes_[id].left; }
+
+  ExprId Right(ExprId id) const { return nodes_[id].right; }
+
+  bool IsNullable(ExprId id) const { return nullable_[id]; }
+
+  // Concatenation factors of `id` in order, however the concatenations are
+  // nested.
+  std::vector<ExprId> Factors(ExprId id) const;
+  // Alternatives of a union, in order.
+  std::vector<ExprId> Alternatives(ExprId id) const;
+
+  // Number of distinct nodes.
+  size_t Size() const { return nodes_.size(); }
+
+  // Lexer syntax with implicit concatenation and only the parentheses that
+  // precedence requires.
+  std::string ToString(ExprId id) const;
+};
@@ -1,9 +1,149 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "mapped-file.hpp"
 #include "nfa.hpp"
+#include "prefilter.hpp"
+#include "searcher.hpp"
+
+namespace {
+
+struct GrepOptions {
+  bool count_only = false;
+  bool line_numbers = false;
+  bool byte_offsets = false;
+  bool show_file_names = false;
+};
+
+void PrintUsage() {
+  std::cerr << "Usage: regex-parser\n"
+               "       regex-parser [-c] [-n] [-b] REGEX FILE...\n"
+               "Without arguments reads a regex from stdin and prints its\n"
+               "minimal and complement automata. Otherwise prints the lines\n"
+               "of FILEs that contain a match of REGEX.\n"
+               "  -c  print only the number of matching lines\n"
+               "  -n  prefix lines with their line number\n"
+               "  -b  prefix lines with the byte offset of their start\n";
+}
+
+// Symbols are letters, so a match never spans a newline and the searcher can
+// run over the whole mapping instead of line by line.
+size_t ScanFile(const Searcher &searcher, std::string_view text,
+                const std::string &name, const GrepOptions &options) {
+  size_t matching_lines = 0;
+  size_t line_number = 1;
+  size_t pos = 0;
+
+  while (pos < text.size()) {
+    auto match = searcher.Find(text, pos);
+    if (!match) {
+      break;
+    }
+
+    size_t line_start = match->start;
+    while (line_start > pos && text[line_start - 1] != '\n') {
+      --line_start;
+    }
+    size_t line_end =
+        match->start + FindByte(text.data() + match->start,
+                                text.size() - match->start, '\n');
+    ++matching_lines;
+
+    if (options.line_numbers) {
+      line_number += std::count(text.begin() + pos,
+                                text.begin() + line_start, '\n');
+    }
+
+    if (!options.count_only) {
+      if (options.show_file_names) {
+        std::cout << name << ':';
+      }
+      if (options.line_numbers) {
+        std::cout << line_number << ':';
+      }
+      if (options.byte_offsets) {
+        std::cout << line_start << ':';
+      }
+      std::cout.write(text.data() + line_start, line_end - line_start);
+      std::cout << '\n';
+    }
+
+    ++line_number;
+    pos = line_end + 1;
+  }
+
+  return matching_lines;
+}
+
+int Grep(int argc, char **argv) {
+  GrepOptions options;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; ++arg) {
+    if (std::strcmp(argv[arg], "-c") == 0) {
+      options.count_only = true;
+    } else if (std::strcmp(argv[arg], "-n") == 0) {
+      options.line_numbers = true;
+    } else if (std::strcmp(argv[arg], "-b") == 0) {
+      options.byte_offsets = true;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  if (argc - arg < 2) {
+    PrintUsage();
+    return 2;
+  }
+
+  Searcher searcher(argv[arg++]);
+  options.show_file_names = argc - arg > 1;
+
+  bool found = false;
+  bool failed = false;
+  for (; arg < argc; ++arg) {
+    std::string name = argv[arg];
+    try {
+      MappedFile file(name);
+      size_t count = ScanFile(searcher, file.View(), name, options);
+      found = found || count > 0;
+
+      if (options.count_only) {
+        if (options.show_file_names) {
+          std::cout << name << ':';
+        }
+        std::cout << count << '\n';
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      failed = true;
+    }
+  }
+
+  std::cout.flush();
+  if (failed) {
+    return 2;
+  }
+  return found ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    std::ios::sync_with_stdio(false);
+    try {
+      return Grep(argc, argv);
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return 2;
+    }
+  }
 
-int main() {
   try {
     std::string regex;
     std::cout << "Enter regex: ";
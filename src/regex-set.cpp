@@ -0,0 +1,78 @@
+#include "regex-set.hpp"
+
+#include <algorithm>
+
+#include "compiled-nfa.hpp"
+
+RegexSet::RegexSet(const std::vector<std::string> &regexes)
+    : size_(static_cast<int>(regexes.size())) {
+  std::vector<std::string> patterns;
+  patterns.reserve(regexes.size());
+  for (const auto &regex : regexes) {
+    patterns.push_back(InfixToPostfixConverter::ParseCompact(regex));
+  }
+
+  NFA dfa = NFAFactory::PatternsToNfa(patterns);
+  dfa.ToMinimal();
+  dfa_ = DenseDFA(dfa);
+
+  // Dense state s + 1 is compiled state s, the dead state accepts nothing.
+  CompiledNFA compiled(dfa);
+  pattern_offsets_.assign(1, 0);
+  pattern_offsets_.push_back(0);
+  for (int state = 0; state < compiled.StateCount(); ++state) {
+    pattern_ids_.insert(pattern_ids_.end(), compiled.PatternIdsBegin(state),
+                        compiled.PatternIdsEnd(state));
+    pattern_offsets_.push_back(static_cast<int>(pattern_ids_.size()));
+  }
+}
+
+void RegexSet::AppendPatternIds(int state, std::vector<int> &ids) const {
+  ids.insert(ids.end(), pattern_ids_.begin() + pattern_offsets_[state],
+             pattern_ids_.begin() + pattern_offsets_[state + 1]);
+}
+
+std::vector<int> RegexSet::MatchingPrefixes(std::string_view str) const {
+  // Only the accepting states on the path matter; each is expanded once.
+  std::vector<int> accepting;
+  int state = dfa_.GetStart();
+  if (dfa_.IsFinal(state)) {
+    accepting.push_back(state);
+  }
+
+  for (char c : str) {
+    state = dfa_.Next(state, static_cast<unsigned char>(c));
+    if (state == DenseDFA::kDeadState) {
+      break;
+    }
+    if (dfa_.IsFinal(state)) {
+      accepting.push_back(state);
+    }
+  }
+
+  std::sort(accepting.begin(), accepting.end());
+  accepting.erase(std::unique(accepting.begin(), accepting.end()),
+                  accepting.end());
+
+  std::vector<int> ids;
+  for (int accepting_state : accepting) {
+    AppendPatternIds(accepting_state, ids);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
+std::vector<int> RegexSet::Matches(std::string_view str) const {
+  int state = dfa_.GetStart();
+  for (char c : str) {
+    state = dfa_.Next(state, static_cast<unsigned char>(c));
+    if (state == DenseDFA::kDeadState) {
+      return {};
+    }
+  }
+
+  std::vector<int> ids;
+  AppendPatternIds(state, ids);
+  return ids;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dense-dfa.hpp"
+
+// Many patterns compiled into one minimal DFA. Every DFA state remembers
+// which patterns it accepts, so one pass over the input reports all
+// matching patterns no matter how many there are. Pattern ids are the
+// indices into the constructor argument.
+class RegexSet {
+  int size_ = 0;
+  DenseDFA dfa_;
+  // Accepted pattern ids of dense state s are
+  // pattern_ids_[pattern_offsets_[s]..pattern_offsets_[s + 1]).
+  std::vector<int> pattern_offsets_;
+  std::vector<int> pattern_ids_;
+
+  void AppendPatternIds(int state, std::vector<int> &ids) const;
+
+public:
+  explicit RegexSet(const std::vector<std::string> &regexes);
+
+  int Size() const { return size_; }
+
+  int StateCount() const { return dfa_.StateCount(); }
+
+  // Sorted ids of the patterns that match some prefix of `str`, i.e. those
+  // whose NFA::ContainsPrefix is not -1.
+  std::vector<int> MatchingPrefixes(std::string_view str) const;
+  // Sorted ids of the patterns that match the whole of `str`.
+  std::vector<int> Matches(std::string_view str) const;
+};
@@ -0,0 +1,103 @@
+#include "searcher.hpp"
+
+#include "nfa.hpp"
+
+Searcher::Searcher(const std::string &regex)
+    : dfa_(NFA(regex).GetMinimal()),
+      literals_(LiteralAnalyzer::Analyze(regex)) {
+  for (int byte = 0; byte < 256; ++byte) {
+    if (dfa_.Next(dfa_.GetStart(), byte) != DenseDFA::kDeadState) {
+      can_start_[byte] = true;
+      ++start_byte_count_;
+      if (start_bytes_.size() < kMaxStartBytes) {
+        start_bytes_ += static_cast<char>(byte);
+      }
+    }
+  }
+}
+
+size_t Searcher::NextCandidate(std::string_view haystack, size_t pos) const {
+  const char *data = haystack.data() + pos;
+  size_t size = haystack.size() - pos;
+
+  if (!literals_.prefix.empty()) {
+    return pos + FindLiteral(data, size, literals_.prefix);
+  }
+  if (start_byte_count_ <= static_cast<int>(kMaxStartBytes)) {
+    return pos + FindAnyByte(data, size, start_bytes_);
+  }
+  while (pos < haystack.size() &&
+         !can_start_[static_cast<unsigned char>(haystack[pos])]) {
+    ++pos;
+  }
+  return pos;
+}
+
+std::optional<Searcher::Match> Searcher::Find(std::string_view haystack,
+                                              size_t from) const {
+  if (from > haystack.size()) {
+    return std::nullopt;
+  }
+
+  if (dfa_.IsFinal(dfa_.GetStart())) {
+    int64_t length = dfa_.ContainsPrefix(haystack.substr(from));
+    return Match{from, static_cast<size_t>(length)};
+  }
+
+  // A match at `pos` contains the inner literal at or after `pos`, so the
+  // search ends once no occurrence is left. `inner_at` is the next one at or
+  // after the current candidate.
+  auto find_inner = [&](size_t pos) {
+    size_t rest = haystack.size() - pos;
+    size_t offset = FindLiteral(haystack.data() + pos, rest, literals_.inner);
+    return offset == rest ? std::string_view::npos : pos + offset;
+  };
+  size_t inner_at = 0;
+  if (!literals_.inner.empty()) {
+    inner_at = find_inner(from);
+    if (inner_at == std::string_view::npos) {
+      return std::nullopt;
+    }
+  }
+  std::unordered_set<uint64_t> failed;
+
+  for (size_t pos = NextCandidate(haystack, from); pos < haystack.size();
+       pos = NextCandidate(haystack, pos + 1)) {
+    if (!literals_.inner.empty() && pos > inner_at) {
+      inner_at = find_inner(pos);
+      if (inner_at == std::string_view::npos) {
+        return std::nullopt;
+      }
+    }
+
+    int64_t length = MatchAt(haystack, pos, failed);
+    if (length >= 0) {
+      return Match{pos, static_cast<size_t>(length)};
+    }
+  }
+
+  return std::nullopt;
+}
+
+int64_t Searcher::MatchAt(std::string_view haystack, size_t pos,
+                          std::unordered_set<uint64_t> &failed) const {
+  // Candidates are tried left to right and stop at the first match, so every
+  // earlier run failed: it never reached a final state. A run that gets to a
+  // pair one of them went through would not reach one either.
+  const uint64_t state_count = static_cast<uint64_t>(dfa_.StateCount());
+  int state = dfa_.GetStart();
+  for (size_t i = pos; i < haystack.size(); ++i) {
+    state = dfa_.Next(state, static_cast<unsigned char>(haystack[i]));
+    if (state == DenseDFA::kDeadState) {
+      return -1;
+    }
+    if (dfa_.IsFinal(state)) {
+      return dfa_.ContainsPrefix(haystack.substr(pos));
+    }
+    if (i - pos >= kUnrecordedSteps &&
+        !failed.insert((i + 1) * state_count + state).second) {
+      return -1;
+    }
+  }
+  return -1;
+}
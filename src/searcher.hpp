@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "dense-dfa.hpp"
+#include "prefilter.hpp"
+
+// Unanchored leftmost-longest search. Candidate start positions are located
+// with the vectorized scans from prefilter.hpp, candidates past the last
+// occurrence of the required inner literal are skipped, and the minimal DFA
+// only runs from the rest. Runs from different candidates share the
+// (position, state) pairs they fail through, so a search takes time linear
+// in the haystack.
+class Searcher {
+  // Start bytes are scanned for with FindAnyByte up to this many; larger
+  // sets use a table.
+  static constexpr size_t kMaxStartBytes = 8;
+  // Steps of each run that are not recorded in the failed pairs. Most
+  // candidates die within them, and skipping them keeps the bound linear.
+  static constexpr size_t kUnrecordedSteps = 16;
+
+  DenseDFA dfa_;
+  RequiredLiterals literals_;
+  std::array<bool, 256> can_start_{};
+  std::string start_bytes_;
+  int start_byte_count_ = 0;
+
+  size_t NextCandidate(std::string_view haystack, size_t pos) const;
+  // Longest match at `pos`, or -1. Gives up on reaching a pair in `failed`
+  // and adds the pairs of a failed run to it.
+  int64_t MatchAt(std::string_view haystack, size_t pos,
+                  std::unordered_set<uint64_t> &failed) const;
+
+public:
+  struct Match {
+    size_t start;
+    size_t length;
+  };
+
+  explicit Searcher(const std::string &regex);
+
+  std::optional<Match> Find(std::string_view haystack, size_t from = 0) const;
+  bool Contains(std::string_view haystack) const {
+    return Find(haystack).has_value();
+  }
+
+  const RequiredLiterals &GetLiterals() const { return literals_; }
+};
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// Regex compiled to a minimal DFA entirely at compile time:
+//
+//   using Ident = StaticRegex<"(a+b).(a+b+c)*">;
+//   static_assert(Ident::Matches("abc"));
+//
+// The syntax is the one Lexer accepts. Construction uses the Glushkov
+// (position) automaton, which has no epsilon edges, so subset construction
+// works on 64-bit position sets; a pattern may have up to 63 symbols.
+// Malformed patterns fail to compile.
+template <size_t N> struct FixedString {
+  char data[N]{};
+
+  constexpr FixedString(const char (&str)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+      data[i] = str[i];
+    }
+  }
+
+  constexpr std::string_view View() const { return {data, N - 1}; }
+};
+
+namespace static_regex {
+
+constexpr int kMaxPositions = 63;
+
+// Position automaton: position 0 is the initial state, positions 1..count
+// are the symbols of the pattern in order.
+struct PositionAutomaton {
+  std::array<char, kMaxPositions + 1> symbols{};
+  std::array<uint64_t, kMaxPositions + 1> follow{};
+  uint64_t last = 0;
+  bool nullable = false;
+  int count = 0;
+};
+
+class Parser {
+  struct Fragment {
+    uint64_t first;
+    uint64_t last;
+    bool nullable;
+  };
+
+  std::string_view pattern_;
+  size_t pos_ = 0;
+  PositionAutomaton automaton_;
+
+  constexpr void SkipSpaces() {
+    while (pos_ < pattern_.size() &&
+           (pattern_[pos_] == ' ' || pattern_[pos_] == '\t' ||
+            pattern_[pos_] == '\n' || pattern_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  constexpr char Peek() {
+    SkipSpaces();
+    return pos_ < pattern_.size() ? pattern_[pos_] : '\0';
+  }
+
+  static constexpr bool IsSymbol(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  }
+
+  constexpr void AddFollow(uint64_t from, uint64_t to) {
+    for (int p = 0; p <= automaton_.count; ++p) {
+      if ((from >> p) & 1) {
+        automaton_.follow[p] |= to;
+      }
+    }
+  }
+
+  constexpr Fragment ParseAtom() {
+    char c = Peek();
+    if (IsSymbol(c)) {
+      ++pos_;
+      if (automaton_.count == kMaxPositions) {
+        throw std::runtime_error("Pattern has too many symbols");
+      }
+      int position = ++automaton_.count;
+      automaton_.symbols[position] = c;
+      uint64_t bit = uint64_t{1} << position;
+      return {bit, bit, false};
+    }
+    if (c == '1') {
+      ++pos_;
+      return {0, 0, true};
+    }
+    if (c == '(') {
+      ++pos_;
+      Fragment inner = ParseUnion();
+      if (Peek() != ')') {
+        throw std::runtime_error("Missing closing parenthesis");
+      }
+      ++pos_;
+      return inner;
+    }
+    throw std::runtime_error("Unexpected character in pattern");
+  }
+
+  constexpr Fragment ParseStar() {
+    Fragment fragment = ParseAtom();
+    while (Peek() == '*') {
+      ++pos_;
+      AddFollow(fragment.last, fragment.first);
+      fragment.nullable = true;
+    }
+    return fragment;
+  }
+
+  constexpr Fragment ParseConcat() {
+    Fragment left = ParseStar();
+    for (;;) {
+      char c = Peek();
+      if (c == '.') {
+        ++pos_;
+      } else if (!IsSymbol(c) && c != '1' && c != '(') {
+        return left;
+      }
+
+      Fragment right = ParseStar();
+      AddFollow(left.last, right.first);
+      left = {left.nullable ? left.first | right.first : left.first,
+              right.nullable ? left.last | right.last : right.last,
+              left.nullable && right.nullable};
+    }
+  }
+
+  constexpr Fragment ParseUnion() {
+    Fragment left = ParseConcat();
+    while (Peek() == '+') {
+      ++pos_;
+      Fragment right = ParseConcat();
+      left = {left.first | right.first, left.last | right.last,
+              left.nullable || right.nullable};
+    }
+    return left;
+  }
+
+public:
+  constexpr explicit Parser(std::string_view pattern) : pattern_(pattern) {}
+
+  constexpr PositionAutomaton Parse() {
+    Fragment whole = ParseUnion();
+    if (Peek() != '\0') {
+      throw std::runtime_error("Unexpected character in pattern");
+    }
+    automaton_.follow[0] = whole.first;
+    automaton_.last = whole.last;
+    automaton_.nullable = whole.nullable;
+    return automaton_;
+  }
+};
+
+// Complete DFA with state 0 as the dead state and byte classes as in
+// DenseDFA. Only used during constant evaluation.
+struct DynamicDFA {
+  std::array<uint8_t, 256> classes{};
+  int class_count = 1;
+  int start = 0;
+  std::vector<int> table;
+  std::vector<bool> finals;
+
+  constexpr int StateCount() const { return static_cast<int>(finals.size()); }
+};
+
+constexpr DynamicDFA Determinize(const PositionAutomaton &automaton) {
+  DynamicDFA dfa;
+  std::vector<char> class_symbols{'\0'};
+  for (int p = 1; p <= automaton.count; ++p) {
+    unsigned char symbol = static_cast<unsigned char>(automaton.symbols[p]);
+    if (dfa.classes[symbol] == 0) {
+      dfa.classes[symbol] = static_cast<uint8_t>(class_symbols.size());
+      class_symbols.push_back(automaton.symbols[p]);
+    }
+  }
+  dfa.class_count = static_cast<int>(class_symbols.size());
+
+  auto is_final = [&](uint64_t set) {
+    return (set & automaton.last) != 0 || ((set & 1) && automaton.nullable);
+  };
+
+  std::vector<uint64_t> sets{0, 1};
+  dfa.finals = {false, is_final(1)};
+  dfa.table.assign(2 * dfa.class_count, 0);
+  dfa.start = 1;
+
+  for (size_t current = 1; current < sets.size(); ++current) {
+    for (int c = 1; c < dfa.class_count; ++c) {
+      uint64_t next = 0;
+      for (int p = 0; p <= automaton.count; ++p) {
+        if ((sets[current] >> p) & 1) {
+          next |= automaton.follow[p];
+        }
+      }
+      for (int p = 1; p <= automaton.count; ++p) {
+        if (automaton.symbols[p] != class_symbols[c]) {
+          next &= ~(uint64_t{1} << p);
+        }
+      }
+
+      size_t target = 0;
+      while (target < sets.size() && sets[target] != next) {
+        ++target;
+      }
+      if (target == sets.size()) {
+        sets.push_back(next);
+        dfa.finals.push_back(is_final(next));
+        dfa.table.resize(sets.size() * dfa.class_count, 0);
+      }
+      dfa.table[current * dfa.class_count + c] = static_cast<int>(target);
+    }
+  }
+
+  return dfa;
+}
+
+// Moore refinement. Blocks are numbered by their first state, so the dead
+// state stays 0 and absorbs every state that can no longer accept.
+constexpr DynamicDFA Minimize(const DynamicDFA &dfa) {
+  int n = dfa.StateCount();
+  int k = dfa.class_count;
+
+  std::vector<int> blocks(n);
+  for (int state = 0; state < n; ++state) {
+    blocks[state] = dfa.finals[state] != dfa.finals[0] ? 1 : 0;
+  }
+  int block_count = 0;
+
+  for (;;) {
+    std::vector<int> next_blocks(n, -1);
+    int next_count = 0;
+    for (int state = 0; state < n; ++state) {
+      for (int earlier = 0; earlier < state && next_blocks[state] == -1;
+           ++earlier) {
+        bool same = blocks[earlier] == blocks[state];
+        for (int c = 0; same && c < k; ++c) {
+          same = blocks[dfa.table[earlier * k + c]] ==
+                 blocks[dfa.table[state * k + c]];
+        }
+        if (same) {
+          next_blocks[state] = next_blocks[earlier];
+        }
+      }
+      if (next_blocks[state] == -1) {
+        next_blocks[state] = next_count++;
+      }
+    }
+
+    blocks = next_blocks;
+    if (next_count == block_count) {
+      break;
+    }
+    block_count = next_count;
+  }
+
+  DynamicDFA minimal;
+  minimal.classes = dfa.classes;
+  minimal.class_count = k;
+  minimal.start = blocks[dfa.start];
+  minimal.finals.assign(block_count, false);
+  minimal.table.assign(block_count * k, 0);
+  for (int state = 0; state < n; ++state) {
+    minimal.finals[blocks[state]] = dfa.finals[state];
+    for (int c = 0; c < k; ++c) {
+      minimal.table[blocks[state] * k + c] = blocks[dfa.table[state * k + c]];
+    }
+  }
+  return minimal;
+}
+
+// Symbols whose columns are identical share a class, as in DenseDFA.
+constexpr DynamicDFA MergeClasses(const DynamicDFA &dfa) {
+  int n = dfa.StateCount();
+  int k = dfa.class_count;
+
+  std::vector<int> class_of(k, -1);
+  std::vector<int> kept;
+  for (int c = 0; c < k; ++c) {
+    for (size_t j = 0; j < kept.size() && class_of[c] == -1; ++j) {
+      bool same = true;
+      for (int state = 0; same && state < n; ++state) {
+        same = dfa.table[state * k + c] == dfa.table[state * k + kept[j]];
+      }
+      if (same) {
+        class_of[c] = static_cast<int>(j);
+      }
+    }
+    if (class_of[c] == -1) {
+      class_of[c] = static_cast<int>(kept.size());
+      kept.push_back(c);
+    }
+  }
+
+  DynamicDFA merged;
+  merged.class_count = static_cast<int>(kept.size());
+  merged.start = dfa.start;
+  merged.finals = dfa.finals;
+  for (int byte = 0; byte < 256; ++byte) {
+    merged.classes[byte] = static_cast<uint8_t>(class_of[dfa.classes[byte]]);
+  }
+  merged.table.assign(n * merged.class_count, 0);
+  for (int state = 0; state < n; ++state) {
+    for (int c = 0; c < merged.class_count; ++c) {
+      merged.table[state * merged.class_count + c] =
+          dfa.table[state * k + kept[c]];
+    }
+  }
+  return merged;
+}
+
+constexpr DynamicDFA Compile(std::string_view pattern) {
+  return MergeClasses(Minimize(Determinize(Parser(pattern).Parse())));
+}
+
+template <int States, int Classes> struct Tables {
+  std::array<uint8_t, 256> classes{};
+  std::array<uint8_t, States> finals{};
+  std::array<int32_t, States * Classes> table{};
+  int start = 0;
+};
+
+// Vectors can't outlive constant evaluation, so the DFA is built once to
+// learn its size and once more to fill fixed-size arrays.
+template <FixedString Pattern> constexpr auto BuildTables() {
+  constexpr int kStates = Compile(Pattern.View()).StateCount();
+  constexpr int kClasses = Compile(Pattern.View()).class_count;
+
+  DynamicDFA dfa = Compile(Pattern.View());
+  Tables<kStates, kClasses> tables;
+  tables.classes = dfa.classes;
+  tables.start = dfa.start;
+  for (int state = 0; state < kStates; ++state) {
+    tables.finals[state] = dfa.finals[state];
+  }
+  for (int i = 0; i < kStates * kClasses; ++i) {
+    tables.table[i] = dfa.table[i];
+  }
+  return tables;
+}
+
+} // namespace static_regex
+
+template <FixedString Pattern> class StaticRegex {
+  static constexpr auto kTables = static_regex::BuildTables<Pattern>();
+  static constexpr int kClassCount =
+      static_cast<int>(kTables.table.size() / kTables.finals.size());
+
+public:
+  static constexpr int kDeadState = 0;
+
+  static constexpr int StateCount() {
+    return static_cast<int>(kTables.finals.size());
+  }
+
+  static constexpr int ClassCount() { return kClassCount; }
+
+  static constexpr int Next(int state, unsigned char byte) {
+    return kTables.table[state * kClassCount + kTables.classes[byte]];
+  }
+
+  // Same result as NFA::ContainsPrefix.
+  static constexpr int64_t ContainsPrefix(std::string_view str) {
+    int state = kTables.start;
+    int64_t longest_match = kTables.finals[state] ? 0 : -1;
+    for (size_t i = 0; i < str.size(); ++i) {
+      state = Next(state, static_cast<unsigned char>(str[i]));
+      if (state == kDeadState) {
+        break;
+      }
+      if (kTables.finals[state]) {
+        longest_match = static_cast<int64_t>(i + 1);
+      }
+    }
+    return longest_match;
+  }
+
+  static constexpr bool Matches(std::string_view str) {
+    int state = kTables.start;
+    for (size_t i = 0; i < str.size() && state != kDeadState; ++i) {
+      state = Next(state, static_cast<unsigned char>(str[i]));
+    }
+    return kTables.finals[state];
+  }
+};
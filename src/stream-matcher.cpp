@@ -0,0 +1,20 @@
+#include "stream-matcher.hpp"
+
+StreamMatcher::StreamMatcher(const DenseDFA &dfa) : dfa_(&dfa) { Reset(); }
+
+bool StreamMatcher::Feed(std::string_view chunk) {
+  return Feed(chunk, [](uint64_t) {});
+}
+
+int64_t StreamMatcher::Finish() {
+  finished_ = true;
+  return longest_match_;
+}
+
+void StreamMatcher::Reset() {
+  state_ = dfa_->GetStart();
+  offset_ = 0;
+  longest_match_ = dfa_->IsFinal(state_) ? 0 : -1;
+  finished_ = false;
+  empty_match_pending_ = longest_match_ == 0;
+}
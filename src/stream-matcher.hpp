@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "dense-dfa.hpp"
+
+// Anchored matching of a stream that arrives in chunks. Only the current
+// DFA state and a few counters are kept between Feed calls, so memory per
+// stream is constant and nothing is allocated while feeding. Many matchers
+// may share one DenseDFA, which must outlive them.
+class StreamMatcher {
+  const DenseDFA *dfa_;
+  int state_ = DenseDFA::kDeadState;
+  uint64_t offset_ = 0;
+  int64_t longest_match_ = -1;
+  bool finished_ = false;
+  // The start state accepts and the empty match has not been reported yet.
+  bool empty_match_pending_ = false;
+
+public:
+  explicit StreamMatcher(const DenseDFA &dfa);
+
+  // Consumes the next chunk and calls on_match(end) with the absolute end
+  // offset of every accepted prefix of the stream, in increasing order. The
+  // empty prefix (end 0) is reported by the first call, even for an empty
+  // chunk. Returns false once no longer prefix can match; later chunks are
+  // ignored.
+  template <typename OnMatch>
+  bool Feed(std::string_view chunk, OnMatch &&on_match) {
+    if (finished_) {
+      throw std::runtime_error("StreamMatcher fed after Finish");
+    }
+    if (empty_match_pending_) {
+      empty_match_pending_ = false;
+      on_match(uint64_t{0});
+    }
+
+    for (size_t i = 0; i < chunk.size() && state_ != DenseDFA::kDeadState;
+         ++i) {
+      state_ = dfa_->Next(state_, static_cast<unsigned char>(chunk[i]));
+      if (dfa_->IsFinal(state_)) {
+        longest_match_ = static_cast<int64_t>(offset_ + i + 1);
+        on_match(static_cast<uint64_t>(longest_match_));
+      }
+    }
+    offset_ += chunk.size();
+    return state_ != DenseDFA::kDeadState;
+  }
+
+  bool Feed(std::string_view chunk);
+
+  // Ends the stream. Returns the length of the longest accepted prefix or -1,
+  // the same as ContainsPrefix on the concatenated chunks.
+  int64_t Finish();
+
+  // True once the outcome is known without more input.
+  bool IsDecided() const {
+    return finished_ || state_ == DenseDFA::kDeadState;
+  }
+
+  int64_t LongestMatch() const { return longest_match_; }
+
+  uint64_t Offset() const { return offset_; }
+
+  // Starts a new stream with the same automaton.
+  void Reset();
+};
@@ -0,0 +1,91 @@
+#include "subset-interner.hpp"
+
+#include <algorithm>
+
+uint64_t SubsetInterner::Hash(const int *begin, const int *end) {
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ static_cast<uint64_t>(end - begin);
+  for (const int *it = begin; it != end; ++it) {
+    hash ^= static_cast<uint32_t>(*it);
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
+
+int SubsetInterner::FindSlot(const int *begin, const int *end,
+                             uint64_t hash) const {
+  size_t mask = table_.size() - 1;
+  size_t length = end - begin;
+
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    int id = table_[slot];
+    if (id == -1) {
+      return static_cast<int>(slot);
+    }
+    if (hashes_[id] == hash &&
+        static_cast<size_t>(offsets_[id + 1] - offsets_[id]) == length &&
+        std::equal(begin, end, states_.begin() + offsets_[id])) {
+      return static_cast<int>(slot);
+    }
+  }
+}
+
+void SubsetInterner::Grow() {
+  std::vector<int> table(std::max<size_t>(16, table_.size() * 2), -1);
+  size_t mask = table.size() - 1;
+
+  for (int id = 0; id < Size(); ++id) {
+    size_t slot = hashes_[id] & mask;
+    while (table[slot] != -1) {
+      slot = (slot + 1) & mask;
+    }
+    table[slot] = id;
+  }
+
+  table_ = std::move(table);
+}
+
+std::pair<int, bool> SubsetInterner::Intern(const std::vector<int> &set) {
+  if (2 * (hashes_.size() + 1) > table_.size()) {
+    Grow();
+  }
+
+  const int *begin = set.data();
+  const int *end = set.data() + set.size();
+  uint64_t hash = Hash(begin, end);
+  int slot = FindSlot(begin, end, hash);
+
+  if (table_[slot] != -1) {
+    return {table_[slot], false};
+  }
+
+  int id = Size();
+  table_[slot] = id;
+  states_.insert(states_.end(), begin, end);
+  offsets_.push_back(static_cast<int>(states_.size()));
+  hashes_.push_back(hash);
+  return {id, true};
+}
+
+int SubsetInterner::Find(const std::vector<int> &set) const {
+  if (table_.empty()) {
+    return -1;
+  }
+
+  const int *begin = set.data();
+  const int *end = set.data() + set.size();
+  return table_[FindSlot(begin, end, Hash(begin, end))];
+}
+
+void SubsetInterner::Clear() {
+  offsets_.assign(1, 0);
+  states_.clear();
+  hashes_.clear();
+  table_.clear();
+}
+
+size_t SubsetInterner::MemoryUsage() const {
+  return offsets_.capacity() * sizeof(int) + states_.capacity() * sizeof(int) +
+         hashes_.capacity() * sizeof(uint64_t) +
+         table_.capacity() * sizeof(int);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Hash-consing table for sorted state sets. Every distinct set is stored once
+// in a shared arena and referred to by a dense id; ids are handed out in
+// insertion order. Hashes are computed once per set and kept alongside it.
+class SubsetInterner {
+  std::vector<int> offsets_{0};
+  std::vector<int> states_;
+  std::vector<uint64_t> hashes_;
+  std::vector<int> table_;
+
+  void Grow();
+  int FindSlot(const int *begin, const int *end, uint64_t hash) const;
+
+public:
+  static uint64_t Hash(const int *begin, const int *end);
+
+  // Returns the id of `set` and whether it was added by this call.
+  std::pair<int, bool> Intern(const std::vector<int> &set);
+  // Returns the id of `set`, or -1 if it has not been interned.
+  int Find(const std::vector<int> &set) const;
+
+  int Size() const { return static_cast<int>(hashes_.size()); }
+
+  const int *Begin(int id) const { return states_.data() + offsets_[id]; }
+
+  const int *End(int id) const { return states_.data() + offsets_[id + 1]; }
+
+  uint64_t GetHash(int id) const { return hashes_[id]; }
+
+  void Clear();
+  // Bytes held by the arena and the hash table.
+  size_t MemoryUsage() const;
+};
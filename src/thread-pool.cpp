@@ -0,0 +1,151 @@
+#include "thread-pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// The pool whose tasks the current thread is running, if any.
+thread_local const WorkStealingPool *current_pool = nullptr;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (unsigned i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  for (unsigned i = 1; i < threads; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+bool WorkStealingPool::PopTask(size_t worker, size_t &task) {
+  {
+    TaskQueue &own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    TaskQueue &victim = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::RunTasks(size_t worker) {
+  // Tasks are only added before a loop starts, so once every deque is empty
+  // there is nothing left to steal.
+  const WorkStealingPool *outer_pool = current_pool;
+  current_pool = this;
+  size_t task;
+  while (PopTask(worker, task)) {
+    try {
+      (*body_)(task);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+  current_pool = outer_pool;
+}
+
+void WorkStealingPool::WorkerLoop(size_t worker) {
+  size_t seen_generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunTasks(worker);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ == 0) {
+        done_.notify_all();
+      }
+    }
+  }
+}
+
+void WorkStealingPool::ParallelFor(size_t count,
+                                   const std::function<void(size_t)> &body) {
+  if (count == 0) {
+    return;
+  }
+  if (current_pool == this) {
+    // The workers may all be inside tasks of the outer loop.
+    for (size_t task = 0; task < count; ++task) {
+      body(task);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> loop_lock(loop_mutex_);
+
+  // Contiguous ranges per worker keep neighbouring tasks on one thread until
+  // stealing kicks in.
+  for (size_t worker = 0; worker < queues_.size(); ++worker) {
+    size_t begin = count * worker / queues_.size();
+    size_t end = count * (worker + 1) / queues_.size();
+    std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+    for (size_t task = begin; task < end; ++task) {
+      queues_[worker]->tasks.push_back(task);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_ = &body;
+    busy_workers_ = workers_.size();
+    error_ = nullptr;
+    ++generation_;
+  }
+  start_.notify_all();
+
+  RunTasks(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_workers_ == 0; });
+    body_ = nullptr;
+    error = error_;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index-parallel loops. Every thread has
+// its own task deque: it pops from the back of its own and, once that is
+// empty, steals from the front of the others, so uneven task costs balance
+// out. The calling thread takes part as worker 0.
+class WorkStealingPool {
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Held for a whole ParallelFor, since the deques serve one loop at a time.
+  std::mutex loop_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(size_t)> *body_ = nullptr;
+  size_t generation_ = 0;
+  size_t busy_workers_ = 0;
+  bool stopping_ = false;
+  std::exception_ptr error_;
+
+  bool PopTask(size_t worker, size_t &task);
+  void RunTasks(size_t worker);
+  void WorkerLoop(size_t worker);
+
+public:
+  // `threads` == 0 uses the hardware concurrency.
+  explicit WorkStealingPool(unsigned threads = 0);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  size_t ThreadCount() const { return queues_.size(); }
+
+  // Calls body(i) for every i in [0, count) and waits for all of them. The
+  // first exception thrown by a task is rethrown here. Calls from several
+  // threads run one after another. A call from inside a task of this pool
+  // runs its loop sequentially on the calling thread.
+  void ParallelFor(size_t count, const std::function<void(size_t)> &body);
+};
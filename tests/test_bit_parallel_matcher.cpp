@@ -0,0 +1,39 @@
+#include "../src/bit-parallel-matcher.hpp"
+#include "../src/nfa.hpp"
+#include "test_helpers.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+template <int Words> void ExpectBitParallelAgrees(const std::string& regex) {
+    ExpectAgreesWithNFA(regex, BitParallelMatcher<Words>(regex),
+                        RandomInputs("abcd", 300, 5));
+}
+
+} // namespace
+
+TEST(BitParallelMatcherTest, AgreesWithNFA) {
+    for (const char* regex :
+         {"a", "a*", "abc", "(a+b)*.c", "1", "(a+1).(b+1).c*",
+          "(a.b+b)*.a.(a+b).(a+b)", "((a.b)*+c)*.a"}) {
+        ExpectBitParallelAgrees<1>(regex);
+        ExpectBitParallelAgrees<2>(regex);
+    }
+}
+
+TEST(BitParallelMatcherTest, MultiwordPatterns) {
+    std::string regex = "(a+b)*";
+    for (int i = 0; i < 40; ++i) {
+        regex += i % 4 == 0 ? ".(a.b)*" : ".(a+b+c)";
+    }
+
+    EXPECT_THROW(BitParallelMatcher<1>{regex}, std::runtime_error);
+    ExpectBitParallelAgrees<2>(regex);
+    ExpectBitParallelAgrees<4>(regex);
+}
+
+TEST(BitParallelMatcherTest, PositionLimit) {
+    std::string regex(63, 'a');
+    EXPECT_EQ(BitParallelMatcher<1>(regex).ContainsPrefix(regex + "a"), 63);
+    EXPECT_THROW(BitParallelMatcher<1>{regex + "a"}, std::runtime_error);
+}
@@ -0,0 +1,57 @@
+#include "../src/codegen.hpp"
+#include "../src/nfa.hpp"
+#include <direct_matcher.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <table_matcher.hpp>
+
+// direct_matcher and table_matcher are generated at build time by
+// regex_generate_matcher from "(a.b+b)*.a.(a+b)".
+TEST(CodeGeneratorTest, GeneratedMatchersAgreeWithNFA) {
+  NFA nfa("(a.b+b)*.a.(a+b)");
+  std::mt19937 rng(9);
+
+  for (int i = 0; i < 300; ++i) {
+    std::string input(rng() % 12, ' ');
+    for (char &c : input) {
+      c = "abc"[rng() % 3];
+    }
+
+    int expected = nfa.ContainsPrefix(input);
+    EXPECT_EQ(direct_matcher::longest_prefix(input), expected) << input;
+    EXPECT_EQ(table_matcher::longest_prefix(input), expected) << input;
+    EXPECT_EQ(direct_matcher::match(input),
+              expected == static_cast<int>(input.size()))
+        << input;
+    EXPECT_EQ(table_matcher::match(input),
+              expected == static_cast<int>(input.size()))
+        << input;
+  }
+}
+
+TEST(CodeGeneratorTest, DirectCodedStates) {
+  NFA dfa = NFA("a.b*").GetMinimal();
+  CodeGenerator::Options options;
+  options.namespace_name = "ab_star";
+  options.source_regex = "a.b*";
+
+  std::string source = CodeGenerator::Generate(dfa, options);
+
+  EXPECT_NE(source.find("from \"a.b*\""), std::string::npos);
+  EXPECT_NE(source.find("namespace ab_star {"), std::string::npos);
+  EXPECT_NE(source.find("state_2:"), std::string::npos);
+  EXPECT_NE(source.find("case 'b':"), std::string::npos);
+  EXPECT_EQ(source.find("kTable"), std::string::npos);
+}
+
+TEST(CodeGeneratorTest, TableStyle) {
+  CodeGenerator::Options options;
+  options.style = CodeGenerator::Style::Table;
+
+  std::string source =
+      CodeGenerator::Generate(NFA("a.b*").GetMinimal(), options);
+
+  EXPECT_NE(source.find("namespace generated_regex {"), std::string::npos);
+  EXPECT_NE(source.find("inline constexpr int kTable[9]"), std::string::npos);
+  EXPECT_EQ(source.find("goto"), std::string::npos);
+}
@@ -0,0 +1,121 @@
+#include "../src/compiled-nfa.hpp"
+#include "../src/nfa.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+TEST(CompiledNFATest, PreservesStatesAndEdges) {
+  NFA nfa("a.b");
+  CompiledNFA compiled(nfa);
+
+  ASSERT_EQ(compiled.StateCount(), static_cast<int>(nfa.GetStates().size()));
+  EXPECT_EQ(compiled.GetOriginalId(compiled.GetStart()), nfa.GetStart()->id);
+
+  int edges = 0;
+  int finals = 0;
+  for (int state = 0; state < compiled.StateCount(); ++state) {
+    edges += compiled.EdgesEnd(state) - compiled.EdgesBegin(state);
+    finals += compiled.IsFinal(state);
+  }
+
+  int expected_edges = 0;
+  int expected_finals = 0;
+  for (const auto &state : nfa.GetStates()) {
+    for (const auto &trans : state->transitions) {
+      expected_edges += static_cast<int>(trans.second.size());
+    }
+    expected_finals += state->is_final;
+  }
+
+  EXPECT_EQ(edges, expected_edges);
+  EXPECT_EQ(finals, expected_finals);
+  EXPECT_EQ(compiled.GetAlphabet(), (std::vector<char>{'a', 'b'}));
+}
+
+TEST(CompiledNFATest, EdgesSortedWithEpsilonFirst) {
+  CompiledNFA compiled(NFA("(a+b)*.c"));
+
+  for (int state = 0; state < compiled.StateCount(); ++state) {
+    for (int e = compiled.EdgesBegin(state) + 1; e < compiled.EdgesEnd(state);
+         ++e) {
+      EXPECT_LE(compiled.EdgeSymbol(e - 1), compiled.EdgeSymbol(e));
+    }
+  }
+}
+
+TEST(CompiledNFATest, FindTargetOnDFA) {
+  NFA nfa("a.b");
+  nfa.ToMinimal();
+  CompiledNFA dfa(nfa);
+
+  int after_a = dfa.FindTarget(dfa.GetStart(), 'a');
+  ASSERT_NE(after_a, -1);
+  EXPECT_EQ(dfa.FindTarget(dfa.GetStart(), 'b'), -1);
+
+  int after_ab = dfa.FindTarget(after_a, 'b');
+  ASSERT_NE(after_ab, -1);
+  EXPECT_TRUE(dfa.IsFinal(after_ab));
+}
+
+TEST(CompiledNFATest, ContainsPrefix) {
+  CompiledNFA compiled(NFA("(a+b)*.c"));
+
+  EXPECT_EQ(compiled.ContainsPrefix("c"), 1);
+  EXPECT_EQ(compiled.ContainsPrefix("abac"), 4);
+  EXPECT_EQ(compiled.ContainsPrefix("abacab"), 4);
+  EXPECT_EQ(compiled.ContainsPrefix("ab"), -1);
+  EXPECT_EQ(compiled.ContainsPrefix("x"), -1);
+}
+
+TEST(CompiledNFATest, ContainsPrefixEmptyMatch) {
+  CompiledNFA compiled(NFA("a*"));
+
+  EXPECT_EQ(compiled.ContainsPrefix(""), 0);
+  EXPECT_EQ(compiled.ContainsPrefix("b"), 0);
+  EXPECT_EQ(compiled.ContainsPrefix("aab"), 2);
+}
+
+TEST(CompiledNFATest, StoredClosuresMatchSearch) {
+  // Nested stars create epsilon cycles that are condensed into components.
+  CompiledNFA compiled(NFA("((a*)*.(1+b)*)*"));
+
+  ASSERT_TRUE(compiled.HasStoredClosure(compiled.GetStart()));
+
+  for (int state = 0; state < compiled.StateCount(); ++state) {
+    if (!compiled.HasStoredClosure(state)) {
+      continue;
+    }
+
+    std::vector<int> reachable{state};
+    std::vector<char> seen(compiled.StateCount(), 0);
+    seen[state] = 1;
+    for (size_t i = 0; i < reachable.size(); ++i) {
+      int current = reachable[i];
+      for (int e = compiled.EdgesBegin(current);
+           e < compiled.EdgesEnd(current) &&
+           compiled.EdgeSymbol(e) == CompiledNFA::kEpsilon;
+           ++e) {
+        if (!seen[compiled.EdgeTarget(e)]) {
+          seen[compiled.EdgeTarget(e)] = 1;
+          reachable.push_back(compiled.EdgeTarget(e));
+        }
+      }
+    }
+
+    std::vector<int> closure(compiled.ClosureBegin(state),
+                             compiled.ClosureEnd(state));
+    ASSERT_TRUE(std::is_sorted(closure.begin(), closure.end()));
+    EXPECT_EQ(closure, compiled.EpsilonClosure({state}));
+
+    for (int member : reachable) {
+      bool has_symbol_edge =
+          compiled.EdgesBegin(member) != compiled.EdgesEnd(member) &&
+          compiled.EdgeSymbol(compiled.EdgesEnd(member) - 1) !=
+              CompiledNFA::kEpsilon;
+      EXPECT_EQ(std::binary_search(closure.begin(), closure.end(), member),
+                has_symbol_edge || compiled.IsFinal(member));
+    }
+  }
+
+  EXPECT_EQ(compiled.ContainsPrefix("aabab"), 5);
+  EXPECT_EQ(compiled.ContainsPrefix(""), 0);
+}
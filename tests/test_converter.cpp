@@ -60,3 +60,37 @@ TEST_F(ConverterTest, KleeneStar) {
   EXPECT_EQ(GetTokenType(postfix[0]), TokenType::Symbol);
   EXPECT_EQ(GetTokenType(postfix[1]), TokenType::KleeneStar);
 }
+
+TEST_F(ConverterTest, CompactParseMatchesTokenPipeline) {
+  for (const char *regex :
+       {"a", "a.b.c", "abc", "a+b*.c", "(a+b)*c", "a(b+c)*d", "1", "(a+1).b*",
+        "((a.b)*+c)* a", "a**", "x y + z", "(a)(b)", "A.b+Z"}) {
+    lexer.Tokenize(regex);
+    lexer.AddConcatenationOperators();
+    auto postfix = converter.Convert(lexer.GetTokens());
+
+    EXPECT_EQ(InfixToPostfixConverter::ParseCompact(regex),
+              InfixToPostfixConverter::Compact(postfix))
+        << regex;
+  }
+}
+
+TEST_F(ConverterTest, CompactParseErrors) {
+  EXPECT_THROW(InfixToPostfixConverter::ParseCompact("(a+b"),
+               std::runtime_error);
+  EXPECT_THROW(InfixToPostfixConverter::ParseCompact("a+b)"),
+               std::runtime_error);
+  EXPECT_THROW(InfixToPostfixConverter::ParseCompact("a-b"),
+               std::runtime_error);
+}
+
+TEST_F(ConverterTest, CompactParseLargeRegex) {
+  std::string regex;
+  for (int i = 0; i < 100000; ++i) {
+    regex += "(a+b)*c";
+  }
+
+  std::string postfix = InfixToPostfixConverter::ParseCompact(regex);
+  EXPECT_EQ(postfix.size(), 100000 * 7 - 1);
+  EXPECT_EQ(postfix.substr(0, 6), "ab+*c.");
+}
@@ -0,0 +1,132 @@
+#include "../src/dense-dfa.hpp"
+#include "../src/nfa.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(DenseDFATest, AgreesWithNFA) {
+  std::mt19937 rng(5);
+
+  for (const char *regex : {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b).(a+b)",
+                            "1", "(a+1).(b+1).c*", "(a.b.c)*"}) {
+    NFA nfa(regex);
+    DenseDFA dense(nfa.GetMinimal());
+
+    for (int i = 0; i < 300; ++i) {
+      std::string input(rng() % 30, ' ');
+      for (char &c : input) {
+        c = "abcd"[rng() % 4];
+      }
+      EXPECT_EQ(dense.ContainsPrefix(input), nfa.ContainsPrefix(input))
+          << "regex: " << regex << ", input: " << input;
+      EXPECT_EQ(dense.Matches(input),
+                nfa.ContainsPrefix(input) == static_cast<int>(input.size()))
+          << "regex: " << regex << ", input: " << input;
+    }
+  }
+}
+
+TEST(DenseDFATest, MergesEquivalentSymbols) {
+  DenseDFA dense(NFA("(a+b+c)*.d").GetMinimal());
+
+  // Bytes outside the alphabet, {a, b, c} and {d}.
+  EXPECT_EQ(dense.ClassCount(), 3);
+  EXPECT_EQ(dense.GetClass('a'), dense.GetClass('c'));
+  EXPECT_NE(dense.GetClass('a'), dense.GetClass('d'));
+  EXPECT_EQ(dense.GetClass('x'), 0);
+}
+
+TEST(DenseDFATest, LongInputs) {
+  DenseDFA dense(NFA("(a.b)*").GetMinimal());
+
+  std::string input;
+  for (int i = 0; i < 1000; ++i) {
+    input += "ab";
+  }
+  EXPECT_TRUE(dense.Matches(input));
+  EXPECT_EQ(dense.ContainsPrefix(input + "aa"), 2000);
+
+  input[501] = 'a';
+  EXPECT_FALSE(dense.Matches(input));
+  EXPECT_EQ(dense.ContainsPrefix(input), 500);
+}
+
+TEST(DenseDFATest, RejectsNondeterministicAutomata) {
+  EXPECT_THROW(DenseDFA(NFA("a*")), std::runtime_error);
+}
+
+TEST(DenseDFATest, DefaultMatchesNothing) {
+  DenseDFA dense;
+
+  EXPECT_EQ(dense.ContainsPrefix("a"), -1);
+  EXPECT_FALSE(dense.Matches(""));
+}
+
+TEST(DenseDFATest, ImageRoundTrip) {
+  for (const char *regex : {"a", "(a+b)*.c", "(a.b+b)*.a.(a+b)", "1"}) {
+    DenseDFA dense(NFA(regex).GetMinimal());
+    auto image = std::make_shared<const std::string>(dense.Serialize());
+    DenseDFA loaded = DenseDFA::FromImage(*image, image);
+
+    EXPECT_EQ(loaded.StateCount(), dense.StateCount());
+    EXPECT_EQ(loaded.ClassCount(), dense.ClassCount());
+    for (const char *input : {"", "a", "c", "abac", "bbac", "ab", "1"}) {
+      EXPECT_EQ(loaded.ContainsPrefix(input), dense.ContainsPrefix(input))
+          << "regex: " << regex << ", input: " << input;
+    }
+  }
+}
+
+TEST(DenseDFATest, LoadsMappedImage) {
+  std::string path = ::testing::TempDir() + "dense_dfa_image.bin";
+  DenseDFA(NFA("(a+b)*.c").GetMinimal()).Save(path);
+
+  DenseDFA loaded = DenseDFA::Load(path);
+  std::remove(path.c_str());
+
+  // The mapping stays alive with the automaton.
+  EXPECT_TRUE(loaded.Matches("abbac"));
+  EXPECT_EQ(loaded.ContainsPrefix("abcab"), 3);
+}
+
+TEST(DenseDFATest, RejectsCorruptImages) {
+  std::string image = DenseDFA(NFA("a.b*").GetMinimal()).Serialize();
+  auto load = [](const std::string &bytes) {
+    auto owner = std::make_shared<const std::string>(bytes);
+    return DenseDFA::FromImage(*owner, owner);
+  };
+
+  std::string flipped = image;
+  flipped.back() ^= 1;
+  EXPECT_THROW(load(flipped), std::runtime_error);
+
+  std::string version = image;
+  version[12] = 99;
+  EXPECT_THROW(load(version), std::runtime_error);
+
+  EXPECT_THROW(load(image.substr(0, image.size() / 2)), std::runtime_error);
+  EXPECT_THROW(load("not an image"), std::runtime_error);
+  EXPECT_NO_THROW(load(image));
+}
+
+TEST(DenseDFATest, RejectsWrappingOffsets) {
+  std::string image = DenseDFA(NFA("a.b*").GetMinimal()).Serialize();
+  auto load = [](const std::string &bytes) {
+    auto owner = std::make_shared<const std::string>(bytes);
+    return DenseDFA::FromImage(*owner, owner, false);
+  };
+  // classes_offset, table_offset and finals_offset are at bytes 32, 40, 48.
+  auto with_offset = [&image](size_t field, uint64_t value) {
+    std::string corrupt = image;
+    std::memcpy(corrupt.data() + field, &value, sizeof(value));
+    return corrupt;
+  };
+
+  // offset + length wraps around to a small value.
+  EXPECT_THROW(load(with_offset(48, UINT64_MAX - 1)), std::runtime_error);
+  EXPECT_THROW(load(with_offset(40, UINT64_MAX - 7)), std::runtime_error);
+  EXPECT_THROW(load(with_offset(32, UINT64_MAX - 255)), std::runtime_error);
+  EXPECT_NO_THROW(load(image));
+}
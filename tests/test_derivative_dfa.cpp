@@ -0,0 +1,58 @@
+#include "../src/derivative-dfa.hpp"
+#include "../src/nfa.hpp"
+#include "test_helpers.hpp"
+#include <gtest/gtest.h>
+
+TEST(DerivativeDFATest, AgreesWithNFA) {
+    for (const char* regex :
+         {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b).(a+b)", "1",
+          "(a+1).(b+1).c*", "(a*.b*)*.c", "((a.b)*+c)*.a"}) {
+        ExpectAgreesWithNFA(regex, DerivativeDFA(regex),
+                            RandomInputs("abcd", 300, 7));
+    }
+}
+
+TEST(DerivativeDFATest, ToDFAIsDeterministicAndEquivalent) {
+    for (const char* regex :
+         {"a", "(a+b)*.c", "(a.b+b)*.a.(a+b).(a+b)", "(a+1).(b+1).c*"}) {
+        NFA dfa = DerivativeDFA(regex).ToDFA();
+        NFA expected = NFA(regex).GetMinimal();
+
+        for (const auto& state : dfa.GetStates()) {
+            for (const auto& [symbol, targets] : state->transitions) {
+                EXPECT_NE(symbol, 0);
+                EXPECT_EQ(targets.size(), 1u);
+            }
+        }
+        EXPECT_GE(dfa.GetStates().size(), expected.GetStates().size());
+        EXPECT_EQ(dfa.GetMinimal().GetStates().size(),
+                  expected.GetStates().size())
+            << regex;
+        for (const auto& input : RandomInputs("abc", 200, 11)) {
+            EXPECT_EQ(dfa.ContainsPrefix(input),
+                      expected.ContainsPrefix(input))
+                << regex << " on " << input;
+        }
+    }
+}
+
+TEST(DerivativeDFATest, BuildsStatesLazily) {
+    // The full DFA has over a thousand states, a short input visits a few.
+    std::string regex = "(a+b)*.a";
+    for (int i = 0; i < 10; ++i) {
+        regex += ".(a+b)";
+    }
+    DerivativeDFA derivatives(regex);
+
+    EXPECT_EQ(derivatives.ContainsPrefix("bbbb"), -1);
+    EXPECT_LE(derivatives.CachedStates(), 3);
+    EXPECT_EQ(derivatives.ToDFA().GetStates().size(), 2048u);
+}
+
+TEST(DerivativeDFATest, EmptyLanguage) {
+    DerivativeDFA derivatives("a.epsilon");
+
+    EXPECT_EQ(derivatives.ContainsPrefix("a"), -1);
+    EXPECT_FALSE(derivatives.Matches(""));
+    EXPECT_EQ(derivatives.ToDFA().GetStates().size(), 1u);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../src/compiled-nfa.hpp"
+#include "../src/nfa.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+// `count` random strings over `alphabet`, each shorter than `max_length`.
+inline std::vector<std::string> RandomInputs(const std::string& alphabet,
+                                             int count, unsigned seed,
+                                             size_t max_length = 24) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> inputs;
+    for (int i = 0; i < count; ++i) {
+        std::string input(rng() % max_length, ' ');
+        for (char& c : input) {
+            c = alphabet[rng() % alphabet.size()];
+        }
+        inputs.push_back(input);
+    }
+    return inputs;
+}
+
+// Checks ContainsPrefix and Matches of `matcher` against the NFA of `regex`
+// on every input.
+template <typename Matcher>
+void ExpectAgreesWithNFA(const std::string& regex, const Matcher& matcher,
+                         const std::vector<std::string>& inputs) {
+    CompiledNFA nfa{NFA(regex)};
+
+    for (const auto& input : inputs) {
+        int64_t expected = nfa.ContainsPrefix(input);
+        EXPECT_EQ(matcher.ContainsPrefix(input), expected)
+            << regex << " on " << input;
+        EXPECT_EQ(matcher.Matches(input),
+                  expected == static_cast<int64_t>(input.size()))
+            << regex << " on " << input;
+    }
+}
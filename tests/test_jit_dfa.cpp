@@ -0,0 +1,37 @@
+#include "../src/jit-dfa.hpp"
+#include "../src/nfa.hpp"
+#include "test_helpers.hpp"
+#include <gtest/gtest.h>
+
+TEST(JitDFATest, AgreesWithNFA) {
+    for (const char* regex :
+         {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b).(a+b)", "1",
+          "(a+1).(b+1).c*", "(a+b+c+d+e+f)*.z"}) {
+        ExpectAgreesWithNFA(regex, JitDFA(NFA(regex).GetMinimal()),
+                            RandomInputs("abcdefz\n", 300, 17, 20));
+    }
+}
+
+TEST(JitDFATest, CompilesOnX86_64) {
+    JitDFA jit(NFA("(a.b)*").GetMinimal());
+
+#if defined(__x86_64__) && defined(__unix__)
+    EXPECT_TRUE(jit.IsCompiled());
+    EXPECT_GT(jit.CodeSize(), 0u);
+#endif
+    EXPECT_EQ(jit.ContainsPrefix("ababa"), 4);
+}
+
+TEST(JitDFATest, LongInputAndMove) {
+    JitDFA jit(NFA("(a+b)*.c").GetMinimal());
+    std::string input(1 << 20, 'a');
+    input.back() = 'c';
+
+    JitDFA moved(std::move(jit));
+    EXPECT_EQ(moved.ContainsPrefix(input),
+              static_cast<int64_t>(input.size()));
+    EXPECT_TRUE(moved.Matches(input));
+
+    input[100] = 'x';
+    EXPECT_EQ(moved.ContainsPrefix(input), -1);
+}
@@ -0,0 +1,93 @@
+#include "../src/lazy-dfa.hpp"
+#include "../src/nfa.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace {
+
+std::vector<std::string> RandomInputs(const std::string &alphabet, int count,
+                                      unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> inputs;
+  for (int i = 0; i < count; ++i) {
+    std::string input(rng() % 24, ' ');
+    for (char &c : input) {
+      c = alphabet[rng() % alphabet.size()];
+    }
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+} // namespace
+
+TEST(LazyDFATest, AgreesWithNFA) {
+  for (const char *regex : {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b).(a+b)",
+                            "1", "(a+1).(b+1).c*"}) {
+    NFA nfa(regex);
+    LazyDFA lazy(nfa);
+
+    for (const auto &input : RandomInputs("abcd", 200, 1)) {
+      EXPECT_EQ(lazy.ContainsPrefix(input), nfa.ContainsPrefix(input))
+          << "regex: " << regex << ", input: " << input;
+    }
+  }
+}
+
+TEST(LazyDFATest, MatchesWholeInput) {
+  LazyDFA lazy(NFA("(a+b)*.c"));
+
+  EXPECT_TRUE(lazy.Matches("abbac"));
+  EXPECT_FALSE(lazy.Matches("abbacc"));
+  EXPECT_FALSE(lazy.Matches(""));
+}
+
+TEST(LazyDFATest, OnlyVisitedStatesAreBuilt) {
+  // The full DFA has 2^10 states, a few short inputs touch only a handful.
+  NFA nfa("(a+b)*.a.(a+b).(a+b).(a+b).(a+b).(a+b).(a+b).(a+b).(a+b).(a+b)");
+  LazyDFA lazy(nfa);
+
+  EXPECT_EQ(lazy.ContainsPrefix("aaaa"), -1);
+  EXPECT_LE(lazy.CachedStates(), 5);
+}
+
+TEST(LazyDFATest, FlushesWhenOverMemoryLimit) {
+  NFA nfa("(a+b)*.a.(a+b).(a+b).(a+b).(a+b).(a+b).(a+b)");
+  LazyDFA lazy(nfa, 1024);
+
+  for (const auto &input : RandomInputs("ab", 300, 2)) {
+    ASSERT_EQ(lazy.ContainsPrefix(input), nfa.ContainsPrefix(input));
+  }
+  EXPECT_GT(lazy.CacheFlushes(), 0u);
+}
+
+TEST(LazyDFATest, SharedBetweenThreads) {
+  NFA nfa("(a+b)*.a.(a+b).(a+b).(a+b).(a+b).(a+b)");
+  LazyDFA lazy(nfa, 2048);
+  auto inputs = RandomInputs("ab", 200, 3);
+
+  std::vector<int> expected;
+  for (const auto &input : inputs) {
+    expected.push_back(nfa.ContainsPrefix(input));
+  }
+
+  std::vector<int> mismatches(4, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 5; ++round) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+          mismatches[t] += lazy.ContainsPrefix(inputs[i]) != expected[i];
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int count : mismatches) {
+    EXPECT_EQ(count, 0);
+  }
+}
@@ -0,0 +1,45 @@
+#include "../src/mapped-file.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string WriteTempFile(const std::string &name,
+                          const std::string &contents) {
+  std::string path = ::testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary) << contents;
+  return path;
+}
+
+} // namespace
+
+TEST(MappedFileTest, ViewsFileContents) {
+  std::string contents = "first line\nsecond line\n";
+  std::string path = WriteTempFile("mapped_file_contents.txt", contents);
+
+  MappedFile file(path);
+  EXPECT_EQ(file.Size(), contents.size());
+  EXPECT_EQ(file.View(), contents);
+
+  MappedFile moved(std::move(file));
+  EXPECT_EQ(moved.View(), contents);
+  EXPECT_TRUE(file.View().empty());
+
+  std::remove(path.c_str());
+}
+
+TEST(MappedFileTest, EmptyFile) {
+  std::string path = WriteTempFile("mapped_file_empty.txt", "");
+
+  MappedFile file(path);
+  EXPECT_EQ(file.Size(), 0u);
+  EXPECT_TRUE(file.View().empty());
+
+  std::remove(path.c_str());
+}
+
+TEST(MappedFileTest, MissingFileThrows) {
+  EXPECT_THROW(MappedFile(::testing::TempDir() + "no_such_file.txt"),
+               std::runtime_error);
+}
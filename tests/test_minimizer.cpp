@@ -0,0 +1,160 @@
+#include "../src/compiled-nfa.hpp"
+#include "../src/minimizer.hpp"
+#include "../src/nfa.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+std::string RandomRegex(std::mt19937 &rng, int depth) {
+  std::uniform_int_distribution<int> pick(0, depth > 0 ? 5 : 1);
+  switch (pick(rng)) {
+  case 0:
+    return std::string(1, "abc"[rng() % 3]);
+  case 1:
+    return rng() % 4 == 0 ? "1" : std::string(1, "ab"[rng() % 2]);
+  case 2:
+  case 3:
+    return "(" + RandomRegex(rng, depth - 1) + "." +
+           RandomRegex(rng, depth - 1) + ")";
+  case 4:
+    return "(" + RandomRegex(rng, depth - 1) + "+" +
+           RandomRegex(rng, depth - 1) + ")";
+  default:
+    return "(" + RandomRegex(rng, depth - 1) + ")*";
+  }
+}
+
+std::vector<int> FinalityBlocks(const CompiledNFA &dfa) {
+  std::vector<int> blocks(dfa.StateCount());
+  for (int state = 0; state < dfa.StateCount(); ++state) {
+    blocks[state] = dfa.IsFinal(state);
+  }
+  return blocks;
+}
+
+} // namespace
+
+TEST(MinimizerTest, HopcroftMatchesMoore) {
+  std::mt19937 rng(12345);
+
+  for (int i = 0; i < 200; ++i) {
+    std::string regex = RandomRegex(rng, 5);
+    NFA nfa(regex);
+    nfa.ToDFA();
+    CompiledNFA dfa(nfa);
+    auto initial = FinalityBlocks(dfa);
+
+    EXPECT_EQ(DFAMinimizer::Hopcroft(dfa, initial),
+              DFAMinimizer::Moore(dfa, initial))
+        << "regex: " << regex;
+  }
+}
+
+TEST(MinimizerTest, ParallelMooreMatchesMoore) {
+  std::mt19937 rng(2024);
+  WorkStealingPool pool(4);
+
+  for (int i = 0; i < 100; ++i) {
+    std::string regex = RandomRegex(rng, 6);
+    NFA nfa(regex);
+    nfa.ToDFA();
+    CompiledNFA dfa(nfa);
+    auto initial = FinalityBlocks(dfa);
+
+    EXPECT_EQ(DFAMinimizer::ParallelMoore(dfa, initial, pool),
+              DFAMinimizer::Moore(dfa, initial))
+        << "regex: " << regex;
+  }
+}
+
+TEST(MinimizerTest, ParallelToMinimalProducesSameAutomaton) {
+  std::string regex = "(a+b)*.a";
+  for (int i = 0; i < 8; ++i) {
+    regex += ".(a+b)";
+  }
+  NFA sequential = NFA(regex).GetMinimal();
+  WorkStealingPool pool(4);
+
+  for (auto algorithm :
+       {MinimizationAlgorithm::Hopcroft, MinimizationAlgorithm::Moore}) {
+    NFA parallel = NFA(regex).GetMinimal(algorithm, 4);
+    NFA pooled(regex);
+    pooled.ToMinimal(algorithm, pool);
+
+    for (const NFA *result : {&parallel, &pooled}) {
+      ASSERT_EQ(result->GetStates().size(), sequential.GetStates().size());
+      for (size_t i = 0; i < sequential.GetStates().size(); ++i) {
+        EXPECT_EQ(result->GetStates()[i]->is_final,
+                  sequential.GetStates()[i]->is_final);
+        EXPECT_EQ(result->GetStates()[i]->transitions,
+                  sequential.GetStates()[i]->transitions);
+      }
+    }
+  }
+}
+
+TEST(MinimizerTest, HopcroftOnChainWithThreads) {
+  // Every state of a chain is told apart only at its own depth, so Moore
+  // would need one round per state here. Hopcroft runs sequentially even
+  // though threads are requested.
+  std::string regex = "a";
+  for (int i = 1; i < 3000; ++i) {
+    regex += ".a";
+  }
+  NFA nfa(regex);
+  nfa.ToMinimal(MinimizationAlgorithm::Hopcroft, 4);
+
+  EXPECT_EQ(nfa.GetStates().size(), 3001u);
+  EXPECT_EQ(nfa.ContainsPrefix(std::string(3001, 'a')), 3000);
+}
+
+TEST(MinimizerTest, AlgorithmsProduceSameAutomaton) {
+  std::mt19937 rng(777);
+
+  for (int i = 0; i < 50; ++i) {
+    std::string regex = RandomRegex(rng, 6);
+    NFA hopcroft = NFA(regex).GetMinimal(MinimizationAlgorithm::Hopcroft);
+    NFA moore = NFA(regex).GetMinimal(MinimizationAlgorithm::Moore);
+
+    ASSERT_EQ(hopcroft.GetStates().size(), moore.GetStates().size());
+    for (const char *input : {"", "a", "ab", "abc", "aabbcc", "cab", "bbbb"}) {
+      EXPECT_EQ(hopcroft.ContainsPrefix(input), moore.ContainsPrefix(input))
+          << "regex: " << regex << ", input: " << input;
+    }
+  }
+}
+
+TEST(MinimizerTest, MergesEquivalentStates) {
+  // (a+b).(a+b) determinizes into separate states after 'a' and 'b'.
+  NFA nfa("(a+b).(a+b)");
+  nfa.ToMinimal();
+
+  EXPECT_EQ(nfa.GetStates().size(), 3u);
+  EXPECT_EQ(nfa.ContainsPrefix("ba"), 2);
+  EXPECT_EQ(nfa.ContainsPrefix("b"), -1);
+}
+
+TEST(MinimizerTest, KeepsExplicitSinkApartFromMissingTransitions) {
+  NFA nfa("a.b");
+  nfa.ToComplete();
+  int complete_states = static_cast<int>(nfa.GetStates().size());
+
+  nfa.ToMinimal();
+
+  EXPECT_EQ(static_cast<int>(nfa.GetStates().size()), complete_states);
+}
+
+TEST(MinimizerTest, RespectsInitialLabels) {
+  NFA nfa("a.a.a");
+  nfa.ToDFA();
+  CompiledNFA dfa(nfa);
+
+  std::vector<int> initial(dfa.StateCount(), 0);
+  auto blocks = DFAMinimizer::Hopcroft(dfa, initial);
+
+  // Even with a single label the states differ in how many 'a's they read
+  // before running into the implicit dead state.
+  EXPECT_EQ(*std::max_element(blocks.begin(), blocks.end()) + 1, 4);
+}
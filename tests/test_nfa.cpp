@@ -325,3 +325,118 @@ TEST_F(NFAPropertiesTest, ToComplement_AllStatesFinal) {
 
     EXPECT_EQ(after_snap.final_states.size(), 0);
 }
+
+TEST_F(NFAPropertiesTest, PostfixToNfa_LongRegex_LinearStateCount) {
+    std::string regex = "a";
+    for (int i = 0; i < 20000; ++i) {
+        regex += (i % 2 == 0) ? ".b" : "+a";
+    }
+    regex = "(" + regex + ")*";
+
+    NFA nfa(regex);
+
+    // Thompson construction adds exactly two states per symbol and operator
+    // (concatenation adds none).
+    EXPECT_EQ(nfa.GetStates().size(), 2u * (20001 + 10000 + 1));
+    EXPECT_EQ(nfa.ContainsPrefix("ab"), 2);
+}
+
+TEST_F(NFAPropertiesTest, ContainsPrefix_SeesLaterChanges) {
+    NFA nfa("a.b");
+    EXPECT_EQ(nfa.ContainsPrefix("ab"), 2);
+    EXPECT_EQ(nfa.ContainsPrefix("b"), -1);
+
+    NFA copy = nfa;
+    nfa.ToComplement();
+    EXPECT_EQ(nfa.ContainsPrefix("ab"), 1);
+    EXPECT_EQ(nfa.ContainsPrefix("b"), 1);
+    EXPECT_EQ(copy.ContainsPrefix("ab"), 2);
+}
+
+TEST_F(NFAPropertiesTest, ContainsPrefix_SeesStatesChangedInPlace) {
+    NFA nfa("a.a.a");
+    nfa.ToDFA();
+    EXPECT_EQ(nfa.ContainsPrefix("aaa"), 3);
+
+    for (auto& state : nfa.GetStates()) {
+        state->is_final = false;
+    }
+
+    EXPECT_EQ(nfa.ContainsPrefix("aaa"), -1);
+    NFA copy = nfa;
+    EXPECT_EQ(copy.ContainsPrefix("aaa"), -1);
+    EXPECT_EQ(nfa.GetMinimal().ContainsPrefix("aaa"), -1);
+}
+
+TEST_F(NFAPropertiesTest, ToDFA_Parallel_IdenticalToSequential) {
+    // Wide BFS levels, so the parallel path is actually taken.
+    std::string regex = "(a+b+c)*.a";
+    for (int i = 0; i < 8; ++i) {
+        regex += ".(a+b+c)";
+    }
+    NFA nfa(regex);
+    NFA sequential = nfa.GetDFA();
+    NFA parallel = nfa.GetDFA(4);
+
+    ASSERT_EQ(parallel.GetStates().size(), sequential.GetStates().size());
+    EXPECT_EQ(parallel.GetStart()->id, sequential.GetStart()->id);
+    for (size_t i = 0; i < sequential.GetStates().size(); ++i) {
+        const auto &expected = sequential.GetStates()[i];
+        const auto &actual = parallel.GetStates()[i];
+        EXPECT_EQ(actual->id, expected->id);
+        EXPECT_EQ(actual->is_final, expected->is_final);
+        EXPECT_EQ(actual->transitions, expected->transitions);
+    }
+}
+
+TEST_F(NFAPropertiesTest, Glushkov_OneStatePerSymbol_NoEpsilon) {
+    NFA nfa("(a+b)*.a.(a+1).c", NFAConstruction::Glushkov);
+
+    EXPECT_EQ(nfa.GetStates().size(), 6u);
+    for (const auto &state : nfa.GetStates()) {
+        EXPECT_EQ(state->transitions.count(0), 0u);
+    }
+    EXPECT_EQ(nfa.GetAlphabet(), (std::set<char>{'a', 'b', 'c'}));
+}
+
+TEST_F(NFAPropertiesTest, Glushkov_SameLanguageAsThompson) {
+    for (const char *regex :
+         {"a", "1", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b)", "(a+1).(b+1)",
+          "((a.b)*+c)*.a", "(a*.b*)*", "a.(b+c)*.(1+a)"}) {
+        NFA thompson(regex);
+        NFA glushkov(regex, NFAConstruction::Glushkov);
+
+        // Every string over {a, b, c} of length up to 6.
+        for (int length = 0, count = 1; length <= 6; ++length, count *= 3) {
+            for (int code = 0; code < count; ++code) {
+                std::string input;
+                for (int i = 0, rest = code; i < length; ++i, rest /= 3) {
+                    input += "abc"[rest % 3];
+                }
+                EXPECT_EQ(glushkov.ContainsPrefix(input),
+                          thompson.ContainsPrefix(input))
+                    << regex << " on " << input;
+            }
+        }
+        EXPECT_EQ(glushkov.GetMinimal().GetStates().size(),
+                  thompson.GetMinimal().GetStates().size())
+            << regex;
+    }
+}
+
+TEST_F(NFAPropertiesTest, Glushkov_WideStar) {
+    // Every position follows every other one: n^2 edges, each added once
+    // even though both stars create them.
+    std::string regex = "a";
+    for (int i = 1; i < 1000; ++i) {
+        regex += "+a";
+    }
+    regex = "((" + regex + ")*)*";
+
+    NFA nfa(regex, NFAConstruction::Glushkov);
+
+    EXPECT_EQ(nfa.GetStates().size(), 1001u);
+    EXPECT_EQ(nfa.GetStates()[1]->transitions.at('a').size(), 1000u);
+    EXPECT_EQ(nfa.GetEnd(), nullptr);
+    EXPECT_EQ(nfa.ContainsPrefix("aaab"), 3);
+}
@@ -0,0 +1,50 @@
+#include "../src/nfa.hpp"
+#include "../src/parallel-scanner.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(ParallelScannerTest, AgreesWithSequentialScan) {
+  std::mt19937 rng(11);
+
+  for (const char *regex :
+       {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b)", "1", "(a+1).(b+1).c*",
+        "(a+b+c)*.a.b.c", "(a.a+b)*"}) {
+    DenseDFA dfa(NFA(regex).GetMinimal());
+
+    for (unsigned threads : {2u, 3u, 8u}) {
+      ParallelScanner scanner(dfa, threads, 1);
+
+      for (int round = 0; round < 50; ++round) {
+        std::string input(rng() % 300, ' ');
+        for (char &c : input) {
+          c = "abc"[rng() % 3];
+        }
+
+        EXPECT_EQ(scanner.ContainsPrefix(input), dfa.ContainsPrefix(input))
+            << "regex: " << regex << ", threads: " << threads
+            << ", input: " << input;
+      }
+    }
+  }
+}
+
+TEST(ParallelScannerTest, MatchEndsInLaterChunk) {
+  DenseDFA dfa(NFA("(a+b)*.c").GetMinimal());
+  ParallelScanner scanner(dfa, 4, 16);
+
+  std::string input(10000, 'a');
+  input[5000] = 'b';
+  input[9998] = 'c';
+  EXPECT_EQ(scanner.ContainsPrefix(input), 9999);
+
+  input[7000] = 'd';
+  EXPECT_EQ(scanner.ContainsPrefix(input), -1);
+}
+
+TEST(ParallelScannerTest, ShortInputIsScannedSequentially) {
+  DenseDFA dfa(NFA("a.b").GetMinimal());
+  ParallelScanner scanner(dfa, 4);
+
+  EXPECT_EQ(scanner.ContainsPrefix("abab"), 2);
+  EXPECT_EQ(scanner.ContainsPrefix(""), -1);
+}
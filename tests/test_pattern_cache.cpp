@@ -0,0 +1,72 @@
+#include "../src/pattern-cache.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(PatternCacheTest, NormalizesSpelling) {
+  EXPECT_EQ(PatternCache::NormalizeRegex("ab"),
+            PatternCache::NormalizeRegex("a.b"));
+  EXPECT_EQ(PatternCache::NormalizeRegex("((a)) + b *"),
+            PatternCache::NormalizeRegex("a+b*"));
+  EXPECT_NE(PatternCache::NormalizeRegex("(a+b)*"),
+            PatternCache::NormalizeRegex("a+b*"));
+}
+
+TEST(PatternCacheTest, CountsHitsAndMisses) {
+  PatternCache cache(8);
+
+  auto first = cache.Get("(a+b)*.c");
+  auto second = cache.Get(" ( a + b ) * c ");
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(cache.Misses(), 1u);
+  EXPECT_EQ(cache.Hits(), 1u);
+  EXPECT_EQ(cache.Size(), 1u);
+  EXPECT_EQ(first->ContainsPrefix("abbac"), 5);
+  EXPECT_EQ(first->GetStates().size(),
+            NFA("(a+b)*.c").GetMinimal().GetStates().size());
+}
+
+TEST(PatternCacheTest, EvictsLeastRecentlyUsed) {
+  PatternCache cache(2);
+
+  auto a = cache.Get("a");
+  cache.Get("b");
+  cache.Get("a");
+  cache.Get("c");
+
+  EXPECT_EQ(cache.Size(), 2u);
+  EXPECT_EQ(cache.Get("a"), a);
+  EXPECT_EQ(cache.Misses(), 3u);
+
+  cache.Get("b");
+  EXPECT_EQ(cache.Misses(), 4u);
+  // Evicted automata stay usable.
+  EXPECT_EQ(a->ContainsPrefix("a"), 1);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_EQ(cache.Hits(), 0u);
+}
+
+TEST(PatternCacheTest, SharedBetweenThreads) {
+  PatternCache cache(4);
+  std::vector<std::thread> threads;
+  std::vector<int> results(8);
+
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 50; ++round) {
+        results[t] = cache.Get(t % 2 ? "a.b*" : "(a+b)*")->ContainsPrefix("ab");
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int result : results) {
+    EXPECT_EQ(result, 2);
+  }
+  EXPECT_EQ(cache.Hits() + cache.Misses(), 400u);
+  EXPECT_EQ(cache.Size(), 2u);
+}
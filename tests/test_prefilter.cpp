@@ -0,0 +1,101 @@
+#include "../src/prefilter.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(PrefilterTest, PrefixLiteral) {
+  auto literals = LiteralAnalyzer::Analyze("abc(d+e)*");
+
+  EXPECT_EQ(literals.prefix, "abc");
+  EXPECT_EQ(literals.inner, "abc");
+}
+
+TEST(PrefilterTest, InnerLiteral) {
+  auto literals = LiteralAnalyzer::Analyze("(a+b)*.xyz.(c+d)");
+
+  EXPECT_EQ(literals.prefix, "");
+  EXPECT_EQ(literals.inner, "xyz");
+}
+
+TEST(PrefilterTest, UnionKeepsCommonParts) {
+  auto literals = LiteralAnalyzer::Analyze("abcx+abdx");
+
+  EXPECT_EQ(literals.prefix, "ab");
+  EXPECT_EQ(literals.inner, "ab");
+
+  literals = LiteralAnalyzer::Analyze("(a.q.r.s+b.q.r.s.t).z");
+  EXPECT_EQ(literals.prefix, "");
+  EXPECT_EQ(literals.inner, "qrs");
+}
+
+TEST(PrefilterTest, OptionalPartsAreNotRequired) {
+  auto literals = LiteralAnalyzer::Analyze("(a+1).bc");
+
+  EXPECT_EQ(literals.prefix, "");
+  EXPECT_EQ(literals.inner, "bc");
+
+  literals = LiteralAnalyzer::Analyze("(ab)*");
+  EXPECT_EQ(literals.prefix, "");
+  EXPECT_EQ(literals.inner, "");
+}
+
+TEST(PrefilterTest, FindByteMatchesMemchr) {
+  std::mt19937 rng(11);
+
+  for (int round = 0; round < 200; ++round) {
+    std::string text(rng() % 200, ' ');
+    for (char &c : text) {
+      c = "abcdefgh"[rng() % 8];
+    }
+    char byte = "abcdefghz"[rng() % 9];
+
+    size_t expected = text.find(byte);
+    if (expected == std::string::npos) {
+      expected = text.size();
+    }
+    EXPECT_EQ(FindByte(text.data(), text.size(), byte), expected);
+  }
+}
+
+TEST(PrefilterTest, FindAnyByteMatchesFindFirstOf) {
+  std::mt19937 rng(13);
+
+  for (int round = 0; round < 300; ++round) {
+    std::string text(rng() % 200, ' ');
+    for (char &c : text) {
+      c = "abcdefgh"[rng() % 8];
+    }
+    std::string bytes(rng() % 5, ' ');
+    for (char &c : bytes) {
+      c = "defghxyz"[rng() % 8];
+    }
+
+    size_t expected = text.find_first_of(bytes);
+    if (expected == std::string::npos) {
+      expected = text.size();
+    }
+    EXPECT_EQ(FindAnyByte(text.data(), text.size(), bytes), expected)
+        << "text: " << text << ", bytes: " << bytes;
+  }
+}
+
+TEST(PrefilterTest, FindLiteralMatchesFind) {
+  std::mt19937 rng(12);
+
+  for (int round = 0; round < 500; ++round) {
+    std::string text(rng() % 300, ' ');
+    for (char &c : text) {
+      c = "abc"[rng() % 3];
+    }
+    std::string literal(1 + rng() % 6, ' ');
+    for (char &c : literal) {
+      c = "abc"[rng() % 3];
+    }
+
+    size_t expected = text.find(literal);
+    if (expected == std::string::npos) {
+      expected = text.size();
+    }
+    EXPECT_EQ(FindLiteral(text.data(), text.size(), literal), expected)
+        << "text: " << text << ", literal: " << literal;
+  }
+}
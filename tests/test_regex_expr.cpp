@@ -0,0 +1,131 @@
+#include "../src/nfa.hpp"
+#include "../src/regex-expr.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+void ExpectSameLanguage(const NFA &expected, const NFA &actual,
+                        const std::string &context) {
+  std::mt19937 rng(3);
+  for (int i = 0; i < 200; ++i) {
+    std::string input(rng() % 10, ' ');
+    for (char &c : input) {
+      c = "abc"[rng() % 3];
+    }
+    EXPECT_EQ(actual.ContainsPrefix(input), expected.ContainsPrefix(input))
+        << context << ", input: " << input;
+  }
+}
+
+} // namespace
+
+TEST(RegexExprTest, SharesEqualSubterms) {
+  RegexExprPool pool;
+  auto ab = pool.Concat(pool.Symbol('a'), pool.Symbol('b'));
+  size_t size = pool.Size();
+
+  EXPECT_EQ(pool.Concat(pool.Symbol('a'), pool.Symbol('b')), ab);
+  EXPECT_EQ(pool.Union(ab, ab), ab);
+  EXPECT_EQ(pool.Size(), size);
+}
+
+TEST(RegexExprTest, AppliesIdentities) {
+  RegexExprPool pool;
+  auto a = pool.Symbol('a');
+
+  EXPECT_EQ(pool.Union(a, RegexExprPool::kEmpty), a);
+  EXPECT_EQ(pool.Concat(RegexExprPool::kOne, a), a);
+  EXPECT_EQ(pool.Concat(a, RegexExprPool::kEmpty), RegexExprPool::kEmpty);
+  EXPECT_EQ(pool.Star(RegexExprPool::kEmpty), RegexExprPool::kOne);
+  EXPECT_EQ(pool.Star(pool.Star(a)), pool.Star(a));
+  EXPECT_EQ(pool.Union(RegexExprPool::kOne, pool.Star(a)), pool.Star(a));
+}
+
+TEST(RegexExprTest, PrintsWithMinimalParentheses) {
+  RegexExprPool pool;
+  auto a = pool.Symbol('a');
+  auto b = pool.Symbol('b');
+  auto c = pool.Symbol('c');
+
+  EXPECT_EQ(pool.ToString(pool.Union(pool.Concat(a, b), c)), "ab+c");
+  EXPECT_EQ(pool.ToString(pool.Concat(pool.Union(a, b), c)), "(a+b)c");
+  EXPECT_EQ(pool.ToString(pool.Star(pool.Concat(a, b))), "(ab)*");
+  EXPECT_EQ(pool.ToString(pool.Concat(pool.Star(a), b)), "a*b");
+  EXPECT_EQ(pool.ToString(pool.Union(RegexExprPool::kOne, a)), "1+a");
+  EXPECT_EQ(pool.ToString(RegexExprPool::kEmpty), "epsilon");
+}
+
+TEST(RegexExprTest, ToRegexRoundTrip) {
+  for (const char *regex : {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b)", "1",
+                            "(a+1).(b+1).c*", "((a.b)*+c)*.a"}) {
+    NFA nfa(regex);
+    ExpectSameLanguage(nfa, NFA(nfa.ToRegex()), regex);
+    ExpectSameLanguage(nfa, NFA(nfa.GetMinimal().ToRegex()), regex);
+  }
+}
+
+TEST(RegexExprTest, ToRegexOnLargeAutomaton) {
+  std::string regex = "(a+b)";
+  for (int i = 0; i < 150; ++i) {
+    regex += i % 10 == 0 ? ".(a.b)*" : ".(a+b+c)";
+  }
+  NFA nfa(regex);
+  ASSERT_GT(nfa.GetStates().size(), 1000u);
+
+  std::string result = nfa.ToRegex();
+  EXPECT_LT(result.size(), 10 * regex.size());
+  ExpectSameLanguage(nfa, NFA(result), "large automaton");
+}
+
+TEST(RegexExprTest, ParsesLexerSyntax) {
+  RegexExprPool pool;
+  auto a = pool.Symbol('a');
+  auto b = pool.Symbol('b');
+
+  EXPECT_EQ(pool.Parse("a.b + a b"), pool.Concat(a, b));
+  EXPECT_EQ(pool.Parse("(a+b)*a"),
+            pool.Concat(pool.Star(pool.Union(a, b)), a));
+  EXPECT_EQ(pool.Parse("epsilon + 1"), RegexExprPool::kOne);
+  EXPECT_THROW(pool.Parse("(a+b"), std::runtime_error);
+  EXPECT_THROW(pool.Parse("a+"), std::runtime_error);
+  EXPECT_THROW(pool.Parse("*a"), std::runtime_error);
+  EXPECT_THROW(pool.Parse("a-b"), std::runtime_error);
+}
+
+TEST(RegexExprTest, SimplifyRegex) {
+  EXPECT_EQ(RegexFactory::SimplifyRegex("(1)*"), "1");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("(epsilon)*"), "1");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("(epsilon)"), "epsilon");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("1a1(b)1"), "ab");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("a+b+a"), "a+b");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("((a*)*)*"), "a*");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("1+ab(ab)*"), "(ab)*");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("abc+abd"), "ab(c+d)");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("ac+bc"), "(a+b)c");
+  EXPECT_EQ(RegexFactory::SimplifyRegex("a.epsilon + b"), "b");
+}
+
+TEST(RegexExprTest, SimplifyLargeRegex) {
+  std::string regex;
+  for (int i = 0; i < 20000; ++i) {
+    regex += "(1.a + 1.a)";
+  }
+
+  EXPECT_EQ(RegexFactory::SimplifyRegex(regex), std::string(20000, 'a'));
+}
+
+TEST(RegexExprTest, SimplifyWideUnion) {
+  // Ten thousand distinct alternatives, each listed twice.
+  std::string alternatives;
+  for (int i = 2; i <= 10000; ++i) {
+    std::string word;
+    for (int n = i; n > 0; n /= 2) {
+      word += "ab"[n % 2];
+    }
+    alternatives += (i > 2 ? "+(" : "(") + word + ")*";
+  }
+
+  EXPECT_EQ(RegexFactory::SimplifyRegex(alternatives + "+" + alternatives),
+            alternatives);
+}
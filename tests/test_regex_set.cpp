@@ -0,0 +1,85 @@
+#include "../src/nfa.hpp"
+#include "../src/regex-set.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+std::vector<int> PerPatternPrefixes(const std::vector<NFA> &nfas,
+                                    const std::string &input) {
+  std::vector<int> ids;
+  for (size_t i = 0; i < nfas.size(); ++i) {
+    if (nfas[i].ContainsPrefix(input) != -1) {
+      ids.push_back(static_cast<int>(i));
+    }
+  }
+  return ids;
+}
+
+} // namespace
+
+TEST(RegexSetTest, AgreesWithPerPatternNFAs) {
+  std::vector<std::string> regexes = {"a.b",      "(a+b)*.c", "a*",
+                                      "b.b.b",    "c+a.c",    "(a.b)*.a",
+                                      "1",        "a.a.a.a",  "(b+c).(b+c)*"};
+  RegexSet set(regexes);
+  std::vector<NFA> nfas;
+  for (const auto &regex : regexes) {
+    nfas.emplace_back(regex);
+  }
+
+  std::mt19937 rng(7);
+  for (int i = 0; i < 300; ++i) {
+    std::string input(rng() % 12, ' ');
+    for (char &c : input) {
+      c = "abcd"[rng() % 4];
+    }
+    EXPECT_EQ(set.MatchingPrefixes(input), PerPatternPrefixes(nfas, input))
+        << "input: " << input;
+  }
+}
+
+TEST(RegexSetTest, MatchesWholeInput) {
+  RegexSet set({"a.b", "a.c", "a.(b+c)", "a*"});
+
+  EXPECT_EQ(set.Matches("ab"), (std::vector<int>{0, 2}));
+  EXPECT_EQ(set.Matches("ac"), (std::vector<int>{1, 2}));
+  EXPECT_EQ(set.Matches("aaa"), (std::vector<int>{3}));
+  EXPECT_EQ(set.Matches(""), (std::vector<int>{3}));
+  EXPECT_TRUE(set.Matches("abc").empty());
+}
+
+TEST(RegexSetTest, MinimizationKeepsAcceptSetsApart) {
+  // Both accepting states behave alike, only their pattern ids differ.
+  RegexSet set({"a.b", "a.c"});
+
+  EXPECT_EQ(set.StateCount(), 5);
+  EXPECT_EQ(set.Matches("ab"), (std::vector<int>{0}));
+  EXPECT_EQ(set.Matches("ac"), (std::vector<int>{1}));
+}
+
+TEST(RegexSetTest, EmptySetMatchesNothing) {
+  RegexSet set({});
+
+  EXPECT_EQ(set.Size(), 0);
+  EXPECT_TRUE(set.MatchingPrefixes("abc").empty());
+  EXPECT_TRUE(set.Matches("").empty());
+}
+
+TEST(RegexSetTest, ManyLiteralPatterns) {
+  std::vector<std::string> regexes;
+  for (int i = 0; i < 256; ++i) {
+    std::string regex;
+    for (int bit = 7; bit >= 0; --bit) {
+      regex += (bit == 7 ? "" : ".");
+      regex += ((i >> bit) & 1) ? 'b' : 'a';
+    }
+    regexes.push_back(regex);
+  }
+  RegexSet set(regexes);
+
+  EXPECT_EQ(set.Size(), 256);
+  EXPECT_EQ(set.MatchingPrefixes("abababab"), (std::vector<int>{0x55}));
+  EXPECT_EQ(set.Matches("bbbbbbbb"), (std::vector<int>{255}));
+  EXPECT_TRUE(set.Matches("abab").empty());
+}
@@ -0,0 +1,100 @@
+#include "../src/nfa.hpp"
+#include "../src/searcher.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+std::optional<Searcher::Match> BruteForceFind(const NFA &nfa,
+                                              const std::string &haystack) {
+  for (size_t pos = 0; pos <= haystack.size(); ++pos) {
+    int64_t length = nfa.ContainsPrefix(haystack.substr(pos));
+    if (length >= 0) {
+      return Searcher::Match{pos, static_cast<size_t>(length)};
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+TEST(SearcherTest, FindsLeftmostLongestMatch) {
+  Searcher searcher("abc(d+e)*");
+
+  auto match = searcher.Find("xxabxabcdedx");
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->start, 5u);
+  EXPECT_EQ(match->length, 6u);
+
+  EXPECT_FALSE(searcher.Find("abdabdab").has_value());
+}
+
+TEST(SearcherTest, ResumesFromOffset) {
+  Searcher searcher("a.b");
+
+  auto match = searcher.Find("ab ab", 1);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->start, 3u);
+}
+
+TEST(SearcherTest, EmptyMatches) {
+  Searcher searcher("a*");
+
+  auto match = searcher.Find("bbaa", 2);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->start, 2u);
+  EXPECT_EQ(match->length, 2u);
+}
+
+TEST(SearcherTest, AgreesWithBruteForce) {
+  std::mt19937 rng(21);
+
+  for (const char *regex : {"a.b.c", "(a+b)*.c.a", "c.(a+b)", "(a.b+b.a)",
+                            "b.a*.c", "(a+c).(b+c).a", "(a+b+x)*.c.c"}) {
+    NFA nfa(regex);
+    Searcher searcher(regex);
+
+    for (int i = 0; i < 200; ++i) {
+      std::string haystack(rng() % 120, ' ');
+      for (char &c : haystack) {
+        c = "abcx"[rng() % 4];
+      }
+
+      auto expected = BruteForceFind(nfa, haystack);
+      auto actual = searcher.Find(haystack);
+      ASSERT_EQ(actual.has_value(), expected.has_value())
+          << "regex: " << regex << ", haystack: " << haystack;
+      if (expected) {
+        EXPECT_EQ(actual->start, expected->start);
+        EXPECT_EQ(actual->length, expected->length);
+      }
+    }
+  }
+}
+
+TEST(SearcherTest, LinearOnFailingRuns) {
+  // Every 'a' is a candidate whose run only dies at the end of the input, so
+  // restarting the DFA at each of them would be quadratic.
+  Searcher searcher("a*.b");
+  std::string haystack(200000, 'a');
+
+  EXPECT_FALSE(searcher.Find(haystack).has_value());
+
+  haystack += 'b';
+  auto match = searcher.Find(haystack, 5);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->start, 5u);
+  EXPECT_EQ(match->length, haystack.size() - 5);
+}
+
+TEST(SearcherTest, SkipsCandidatesAfterLastInnerLiteral) {
+  Searcher searcher("(a+b)*.c.d.(a+b)*");
+  ASSERT_EQ(searcher.GetLiterals().inner, "cd");
+
+  EXPECT_FALSE(searcher.Find(std::string(100000, 'a') + "c").has_value());
+
+  auto match = searcher.Find("xxbcdaxcd");
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->start, 2u);
+  EXPECT_EQ(match->length, 4u);
+}
@@ -0,0 +1,40 @@
+#include "../src/nfa.hpp"
+#include "../src/static-regex.hpp"
+#include "test_helpers.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+template <FixedString Pattern> void ExpectStaticAgreesWithNFA(unsigned seed) {
+    ExpectAgreesWithNFA(std::string(Pattern.View()), StaticRegex<Pattern>{},
+                        RandomInputs("abcd", 200, seed, 16));
+}
+
+} // namespace
+
+static_assert(StaticRegex<"(a+b)*.c">::Matches("abbac"));
+static_assert(!StaticRegex<"(a+b)*.c">::Matches("abbacc"));
+static_assert(StaticRegex<"a b (c)">::ContainsPrefix("abcabc") == 3);
+static_assert(StaticRegex<"1">::ContainsPrefix("") == 0);
+static_assert(StaticRegex<"a*">::ContainsPrefix("aab") == 2);
+
+TEST(StaticRegexTest, AgreesWithNFA) {
+    ExpectStaticAgreesWithNFA<"a">(1);
+    ExpectStaticAgreesWithNFA<"a*">(2);
+    ExpectStaticAgreesWithNFA<"(a+b)*.c">(3);
+    ExpectStaticAgreesWithNFA<"(a.b+b)*.a.(a+b).(a+b)">(4);
+    ExpectStaticAgreesWithNFA<"1">(5);
+    ExpectStaticAgreesWithNFA<"(a+1).(b+1).c*">(6);
+    ExpectStaticAgreesWithNFA<"((a.b)*+c)*.d">(7);
+}
+
+TEST(StaticRegexTest, DFAIsMinimal) {
+    // The minimal DFA of the NFA plus the dead state.
+    EXPECT_EQ(
+        StaticRegex<"(a+b)*.a.(a+b).(a+b)">::StateCount(),
+        static_cast<int>(
+            NFA("(a+b)*.a.(a+b).(a+b)").GetMinimal().GetStates().size()) +
+            1);
+    static_assert(StaticRegex<"a.b+a.c">::StateCount() == 4);
+    static_assert(StaticRegex<"(a+b+c)*">::ClassCount() == 2);
+}
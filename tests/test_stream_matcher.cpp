@@ -0,0 +1,82 @@
+#include "../src/nfa.hpp"
+#include "../src/stream-matcher.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(StreamMatcherTest, ChunkedInputAgreesWithContainsPrefix) {
+  std::mt19937 rng(5);
+
+  for (const char *regex : {"a", "a*", "(a+b)*.c", "(a.b+b)*.a.(a+b)", "1",
+                            "(a+1).(b+1).c*"}) {
+    NFA nfa(regex);
+    DenseDFA dfa(nfa.GetMinimal());
+
+    for (int round = 0; round < 100; ++round) {
+      std::string input(rng() % 20, ' ');
+      for (char &c : input) {
+        c = "abc"[rng() % 3];
+      }
+
+      StreamMatcher matcher(dfa);
+      size_t pos = 0;
+      while (pos < input.size()) {
+        size_t length = 1 + rng() % 4;
+        matcher.Feed(std::string_view(input).substr(pos, length));
+        pos += length;
+      }
+
+      EXPECT_EQ(matcher.Finish(), nfa.ContainsPrefix(input))
+          << "regex: " << regex << ", input: " << input;
+    }
+  }
+}
+
+TEST(StreamMatcherTest, ReportsAbsoluteOffsets) {
+  DenseDFA dfa(NFA("(a.b)*").GetMinimal());
+  StreamMatcher matcher(dfa);
+  std::vector<uint64_t> ends;
+  auto record = [&](uint64_t end) { ends.push_back(end); };
+
+  EXPECT_TRUE(matcher.Feed("aba", record));
+  EXPECT_TRUE(matcher.Feed("bab", record));
+  EXPECT_EQ(ends, (std::vector<uint64_t>{0, 2, 4, 6}));
+  EXPECT_EQ(matcher.Offset(), 6u);
+  EXPECT_FALSE(matcher.IsDecided());
+
+  EXPECT_FALSE(matcher.Feed("bb", record));
+  EXPECT_TRUE(matcher.IsDecided());
+  EXPECT_EQ(matcher.Finish(), 6);
+  EXPECT_THROW(matcher.Feed("a"), std::runtime_error);
+}
+
+TEST(StreamMatcherTest, ResetStartsNewStream) {
+  DenseDFA dfa(NFA("a.b.c").GetMinimal());
+  StreamMatcher matcher(dfa);
+
+  matcher.Feed("ab");
+  matcher.Feed("x");
+  EXPECT_EQ(matcher.Finish(), -1);
+
+  matcher.Reset();
+  matcher.Feed("a");
+  matcher.Feed("bc");
+  EXPECT_EQ(matcher.Finish(), 3);
+}
+
+TEST(StreamMatcherTest, ReportsEmptyMatchOnce) {
+  DenseDFA dfa(NFA("a*").GetMinimal());
+  StreamMatcher matcher(dfa);
+  std::vector<uint64_t> ends;
+  auto record = [&](uint64_t end) { ends.push_back(end); };
+
+  EXPECT_TRUE(matcher.Feed("", record));
+  EXPECT_TRUE(matcher.Feed("aa", record));
+  EXPECT_FALSE(matcher.Feed("b", record));
+  EXPECT_EQ(ends, (std::vector<uint64_t>{0, 1, 2}));
+  EXPECT_EQ(matcher.Finish(), 2);
+
+  ends.clear();
+  matcher.Reset();
+  EXPECT_FALSE(matcher.Feed("b", record));
+  EXPECT_EQ(ends, (std::vector<uint64_t>{0}));
+}
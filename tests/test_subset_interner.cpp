@@ -0,0 +1,60 @@
+#include "../src/nfa.hpp"
+#include "../src/subset-interner.hpp"
+#include <gtest/gtest.h>
+
+TEST(SubsetInternerTest, AssignsDenseIdsInInsertionOrder) {
+  SubsetInterner interner;
+
+  EXPECT_EQ(interner.Intern({1, 2, 3}), std::make_pair(0, true));
+  EXPECT_EQ(interner.Intern({}), std::make_pair(1, true));
+  EXPECT_EQ(interner.Intern({4}), std::make_pair(2, true));
+  EXPECT_EQ(interner.Intern({1, 2, 3}), std::make_pair(0, false));
+  EXPECT_EQ(interner.Intern({}), std::make_pair(1, false));
+  EXPECT_EQ(interner.Size(), 3);
+}
+
+TEST(SubsetInternerTest, StoresSetsInArena) {
+  SubsetInterner interner;
+  interner.Intern({5, 7});
+  interner.Intern({1});
+
+  EXPECT_EQ(std::vector<int>(interner.Begin(0), interner.End(0)),
+            (std::vector<int>{5, 7}));
+  EXPECT_EQ(std::vector<int>(interner.Begin(1), interner.End(1)),
+            (std::vector<int>{1}));
+  EXPECT_EQ(interner.GetHash(0),
+            SubsetInterner::Hash(interner.Begin(0), interner.End(0)));
+}
+
+TEST(SubsetInternerTest, FindAndGrow) {
+  SubsetInterner interner;
+  EXPECT_EQ(interner.Find({1}), -1);
+
+  for (int i = 0; i < 1000; ++i) {
+    interner.Intern({i, i + 1});
+  }
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(interner.Find({i, i + 1}), i);
+  }
+  EXPECT_EQ(interner.Find({0, 2}), -1);
+
+  interner.Clear();
+  EXPECT_EQ(interner.Size(), 0);
+  EXPECT_EQ(interner.Find({0, 1}), -1);
+}
+
+TEST(SubsetInternerTest, ToDFAIsDeterministic) {
+  NFA nfa("(a+b)*.a.(a+b).(a+b)");
+  nfa.ToDFA();
+
+  // The last three symbols must be remembered: 2^3 subsets are reachable.
+  EXPECT_EQ(nfa.GetStates().size(), 8u);
+  for (const auto &state : nfa.GetStates()) {
+    for (const auto &trans : state->transitions) {
+      EXPECT_NE(trans.first, 0);
+      EXPECT_EQ(trans.second.size(), 1u);
+    }
+  }
+  EXPECT_EQ(nfa.ContainsPrefix("babab"), 4);
+}
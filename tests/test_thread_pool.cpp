@@ -0,0 +1,81 @@
+#include "../src/thread-pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+TEST(WorkStealingPoolTest, RunsEveryTaskOnce) {
+  WorkStealingPool pool(4);
+  EXPECT_EQ(pool.ThreadCount(), 4u);
+
+  std::vector<std::atomic<int>> runs(1000);
+  for (int round = 0; round < 3; ++round) {
+    pool.ParallelFor(runs.size(), [&](size_t i) { ++runs[i]; });
+  }
+
+  for (const auto &count : runs) {
+    EXPECT_EQ(count.load(), 3);
+  }
+}
+
+TEST(WorkStealingPoolTest, StealsFromBusyWorker) {
+  WorkStealingPool pool(4);
+  const std::thread::id caller = std::this_thread::get_id();
+  std::mutex mutex;
+  std::condition_variable stolen_signal;
+  bool stolen = false;
+
+  // Tasks 0-15 are queued for the calling thread, which takes part as
+  // worker 0. The first of them it runs blocks until another thread has run
+  // one, which only happens by stealing. The timeout just keeps a broken
+  // pool from hanging the test.
+  pool.ParallelFor(64, [&](size_t i) {
+    if (i >= 16) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    if (std::this_thread::get_id() != caller) {
+      stolen = true;
+      stolen_signal.notify_all();
+    } else {
+      stolen_signal.wait_for(lock, std::chrono::seconds(10),
+                             [&] { return stolen; });
+    }
+  });
+
+  EXPECT_TRUE(stolen);
+}
+
+TEST(WorkStealingPoolTest, NestedAndConcurrentLoops) {
+  WorkStealingPool pool(3);
+  std::atomic<int> runs{0};
+
+  pool.ParallelFor(8, [&](size_t) {
+    pool.ParallelFor(8, [&](size_t) { ++runs; });
+  });
+  EXPECT_EQ(runs.load(), 64);
+
+  std::thread other([&] { pool.ParallelFor(100, [&](size_t) { ++runs; }); });
+  pool.ParallelFor(100, [&](size_t) { ++runs; });
+  other.join();
+  EXPECT_EQ(runs.load(), 264);
+}
+
+TEST(WorkStealingPoolTest, RethrowsTaskException) {
+  WorkStealingPool pool(3);
+
+  EXPECT_THROW(pool.ParallelFor(100,
+                                [](size_t i) {
+                                  if (i == 42) {
+                                    throw std::runtime_error("task failed");
+                                  }
+                                }),
+               std::runtime_error);
+
+  std::atomic<int> runs{0};
+  pool.ParallelFor(10, [&](size_t) { ++runs; });
+  EXPECT_EQ(runs.load(), 10);
+}